@@ -0,0 +1,104 @@
+//////
+/// checks that the finders of the generated position_source mapping make
+/// no heap allocation for string_view and character buffer keys, built
+/// against the synthetic connection of framework/bench
+///
+///   g++ -std=c++17 -O2 -Iframework/bench -I. -o finder_allocations
+///     finder_allocations.cpp -lpthread
+//////
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <framework/bench/allocations.hpp>
+#include <framework/synthetic.hpp>
+#include "position_source.hpp"
+
+namespace {
+
+  constexpr std::size_t rows  = 10000;
+  constexpr std::size_t width = 64;
+
+  int failures = 0;
+
+  //////
+  /// runs lookup once per row and reports what it allocated
+  //////
+  template <typename Lookup>
+  void check(const char* name, Lookup lookup) {
+
+    std::size_t found = 0;
+    rates::framework::allocation_count allocated;
+    for (std::size_t i = 0; i < rows; ++i) {
+      found += lookup(i) ? 1 : 0;
+    }
+    std::size_t count = allocated.count();
+    std::cout << name << ": " << found << " of " << rows << " found, "
+              << count << " allocations" << std::endl;
+    if (count != 0 || found != rows) {
+      ++failures;
+    }
+  }
+
+}
+
+int
+main() {
+
+  using rates::generated::position_source_mapping;
+
+  auto conn = std::make_shared<rates::connection>(rows);
+  conn->column("position_source", width, rows);
+  auto& m = position_source_mapping::instance();
+  if (! m.load(conn)) {
+    std::cerr << "load failed" << std::endl;
+    return 1;
+  }
+
+  //////
+  /// the keys as the decoder hands them over, built before counting
+  //////
+  std::vector<std::string> keys;
+  std::vector<std::vector<char>> buffers;
+  for (std::size_t i = 0; i < rows; ++i) {
+    std::string text = rates::framework::synthetic_text("position_source", i, width);
+    keys.push_back(rates::framework::synthetic_padded(text, width));
+    buffers.emplace_back(keys.back().begin(), keys.back().end());
+  }
+
+  check("find_by_composite_key string_view", [&](std::size_t i) {
+    return bool(m.find_by_composite_key(std::string_view(keys[i]), int(i)));
+  });
+  check("find_by_composite_key buffer", [&](std::size_t i) {
+    return bool(m.find_by_composite_key(std::string_view(buffers[i].data(), width), int(i)));
+  });
+  check("find_by_source string_view", [&](std::size_t i) {
+    return bool(m.find_by_source(std::string_view(keys[i])));
+  });
+  check("find_by_source buffer", [&](std::size_t i) {
+    return bool(m.find_by_source(std::string_view(buffers[i].data(), width)));
+  });
+  check("find_by_index", [&](std::size_t i) {
+    return bool(m.find_by_index(int(i)));
+  });
+  check("find_all_by_source", [&](std::size_t i) {
+    auto r = m.find_all_by_source(std::string_view(keys[i]));
+    return ! r.empty();
+  });
+  check("find_all_by_index", [&](std::size_t i) {
+    auto r = m.find_all_by_index(int(i));
+    return ! r.empty();
+  });
+  check("count_by_source", [&](std::size_t i) {
+    return m.count_by_source(std::string_view(keys[i])) == 1;
+  });
+  check("exists_by_source", [&](std::size_t i) {
+    return m.exists_by_source(std::string_view(buffers[i].data(), width));
+  });
+  check("exists_by_index", [&](std::size_t i) {
+    return m.exists_by_index(int(i));
+  });
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// hints the cache line holding address into the cache, a no-op where
+  /// the compiler has no prefetch builtin
+  //////
+  void prefetch(const void* address);
+
+  //////
+  /// prefetches the first node of the bucket key hashes to in a hashed
+  /// index, reading the bucket slot on the way
+  //////
+  template <typename Index, typename Key>
+  void prefetch_bucket(const Index& index, const Key& key);
+
+  //////
+  /// prefetches the row the first node of that bucket points at, issue
+  /// it some keys after prefetch_bucket so the node is already cached
+  //////
+  template <typename Index, typename Key>
+  void prefetch_bucket_value(const Index& index, const Key& key);
+
+  //////
+  /// prefetch
+  //////
+  inline void
+  prefetch(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void) address;
+#endif
+  }
+
+  //////
+  /// prefetch_bucket
+  //////
+  template <typename Index, typename Key>
+  inline void
+  prefetch_bucket(const Index& index, const Key& key) {
+
+    auto q = index.begin(index.hash_function()(key) % index.bucket_count());
+    if (q != index.end(0)) {
+      prefetch(std::addressof(*q));
+    }
+  }
+
+  //////
+  /// prefetch_bucket_value
+  //////
+  template <typename Index, typename Key>
+  inline void
+  prefetch_bucket_value(const Index& index, const Key& key) {
+
+    auto q = index.begin(index.hash_function()(key) % index.bucket_count());
+    if (q != index.end(0)) {
+      prefetch(std::addressof(**q));
+    }
+  }
+
+}}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+//////
+/// counts heap allocations for the allocation checks and benchmarks, the
+/// header replaces the global operator new and delete, so exactly one
+/// translation unit of a program includes it
+//////
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// allocations made by the program so far, by every thread
+  //////
+  std::size_t allocations();
+
+  //////
+  /// class allocation_count
+  ///
+  /// the allocations made since it was constructed
+  //////
+  class allocation_count {
+  public:
+
+    allocation_count();
+    std::size_t count() const;
+
+  private:
+
+    //////
+    /// class members
+    //////
+    std::size_t  start_;
+  };
+
+  //////
+  /// bumped by the replaced operator new
+  //////
+  inline std::atomic<std::size_t> allocation_counter{0};
+
+  //////
+  /// allocations
+  //////
+  inline std::size_t
+  allocations() {
+    return allocation_counter.load(std::memory_order_relaxed);
+  }
+
+  //////
+  /// constructor
+  //////
+  inline
+  allocation_count::
+  allocation_count() :
+    start_(allocations()) {
+  }
+
+  //////
+  /// count
+  //////
+  inline std::size_t
+  allocation_count::
+  count() const {
+    return allocations() - start_;
+  }
+
+}}
+
+//////
+/// replacements, every form is replaced so memory from one is never
+/// released by the library's version of another, each new counts once
+//////
+namespace rates {
+namespace framework {
+namespace detail {
+
+  inline void*
+  counted_alloc(std::size_t size) noexcept {
+    allocation_counter.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+  }
+
+  inline void*
+  counted_alloc(std::size_t size, std::align_val_t align) noexcept {
+    allocation_counter.fetch_add(1, std::memory_order_relaxed);
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (alignment < sizeof(void*)) {
+      alignment = sizeof(void*);
+    }
+    void* p = nullptr;
+    return ::posix_memalign(&p, alignment, size ? size : 1) == 0 ? p : nullptr;
+  }
+
+}}}
+
+void*
+operator new(std::size_t size) {
+
+  if (void* p = rates::framework::detail::counted_alloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void*
+operator new[](std::size_t size) {
+
+  if (void* p = rates::framework::detail::counted_alloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return rates::framework::detail::counted_alloc(size);
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return rates::framework::detail::counted_alloc(size);
+}
+
+void*
+operator new(std::size_t size, std::align_val_t align) {
+
+  if (void* p = rates::framework::detail::counted_alloc(size, align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void*
+operator new[](std::size_t size, std::align_val_t align) {
+
+  if (void* p = rates::framework::detail::counted_alloc(size, align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void*
+operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return rates::framework::detail::counted_alloc(size, align);
+}
+
+void*
+operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return rates::framework::detail::counted_alloc(size, align);
+}
+
+void
+operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void
+operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void
+operator delete(void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+void
+operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void
+operator delete[](void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void
+operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+void
+operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <framework/synthetic.hpp>
+
+//////
+/// stands in for the database layer in the generated benchmarks, the
+/// benchmark build puts framework/bench ahead of the real db headers so
+/// the generated mapping compiles unchanged against this connection
+//////
+
+#ifndef FAIL
+#define FAIL          0
+#endif
+#ifndef SUCCEED
+#define SUCCEED       1
+#endif
+#ifndef REG_ROW
+#define REG_ROW       -1
+#endif
+#ifndef NO_MORE_ROWS
+#define NO_MORE_ROWS  -2
+#endif
+
+namespace rates {
+
+  //////
+  /// class connection
+  ///
+  /// an in-memory result set, every execute returns the same rows and
+  /// nextRow writes the values of the next one into the bound members,
+  /// strings through framework::synthetic_text and numbers through
+  /// framework::synthetic_number, so nothing is stored per row
+  //////
+  class connection {
+  public:
+
+    //////
+    /// constructor, rows is what every execute returns
+    //////
+    explicit connection(std::size_t rows);
+
+    //////
+    /// declares a column, width is the capacity of a string buffer bound
+    /// to it and distinct the number of different values it holds,
+    /// undeclared columns are unique with no string width
+    //////
+    void column(const std::string& name, std::size_t width, std::size_t distinct);
+
+    //////
+    /// binding, a string column into a character buffer, any other into
+    /// a number
+    //////
+    void genericBind(const std::string& name, char* buffer);
+
+    template <typename T>
+    void genericBind(const std::string& name, T& value);
+
+    //////
+    /// execute rewinds the result set, nextRow fills the bindings
+    //////
+    int execute(const std::string& sql);
+    int nextRow();
+
+  private:
+
+    using binding = std::function<void (std::size_t row)>;
+
+    struct shape {
+      std::size_t  width;
+      std::size_t  distinct;
+    };
+
+    shape shape_of(const std::string& name) const;
+
+    //////
+    /// class members
+    //////
+    std::size_t                   rows_;
+    std::size_t                   row_;
+    std::map<std::string, shape>  columns_;
+    std::vector<binding>          bindings_;
+  };
+  using connection_ptr = std::shared_ptr<connection>;
+
+  //////
+  /// constructor
+  //////
+  inline
+  connection::
+  connection(std::size_t rows) :
+    rows_(rows),
+    row_(0) {
+  }
+
+  //////
+  /// column
+  //////
+  inline void
+  connection::
+  column(const std::string& name, std::size_t width, std::size_t distinct) {
+    columns_[name] = shape{width, distinct};
+  }
+
+  //////
+  /// binding
+  //////
+
+  inline void
+  connection::
+  genericBind(const std::string& name, char* buffer) {
+
+    shape s = shape_of(name);
+    if (s.width == 0) {
+      return;
+    }
+    bindings_.push_back([name, s, buffer](std::size_t row) {
+      std::string text = framework::synthetic_text(
+        name, framework::synthetic_key(row, s.distinct), s.width);
+      std::memcpy(buffer, text.c_str(), text.size() + 1);
+    });
+  }
+
+  template <typename T>
+  inline void
+  connection::
+  genericBind(const std::string& name, T& value) {
+
+    static_assert(std::is_arithmetic<T>::value, "genericBind needs a number");
+    shape s = shape_of(name);
+    T* target = &value;
+    bindings_.push_back([s, target](std::size_t row) {
+      *target = framework::synthetic_number<T>(framework::synthetic_key(row, s.distinct));
+    });
+  }
+
+  //////
+  /// execute
+  //////
+  inline int
+  connection::
+  execute(const std::string&) {
+    row_ = 0;
+    bindings_.clear();
+    return SUCCEED;
+  }
+
+  //////
+  /// nextRow
+  //////
+  inline int
+  connection::
+  nextRow() {
+
+    if (row_ == rows_) {
+      return NO_MORE_ROWS;
+    }
+    for (auto& bind : bindings_) {
+      bind(row_);
+    }
+    ++row_;
+    return REG_ROW;
+  }
+
+  //////
+  /// shape_of
+  //////
+  inline connection::shape
+  connection::
+  shape_of(const std::string& name) const {
+
+    auto i = columns_.find(name);
+    return i != columns_.end() ? i->second : shape{0, rows_};
+  }
+
+}
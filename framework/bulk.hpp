@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <boost/mpl/size.hpp>
+
+namespace rates {
+namespace framework {
+
+  namespace detail {
+
+    //////
+    /// reserves a hashed index for n rows, other indices have nothing
+    /// to reserve
+    //////
+    template <typename Index>
+    inline auto
+    reserve_index(Index& index, std::size_t n, int) -> decltype(index.reserve(n), void()) {
+      index.reserve(n);
+    }
+
+    template <typename Index>
+    inline void
+    reserve_index(Index&, std::size_t, long) {
+    }
+
+    template <typename Table, std::size_t... I>
+    inline void
+    reserve_indices(Table& table, std::size_t n, std::index_sequence<I...>) {
+      (reserve_index(table.template get<I>(), n, 0), ...);
+    }
+
+    //////
+    /// orders rows the way an ordered index keeps them, rows with equal
+    /// keys keep their fetch order so the first fetched still wins a
+    /// unique index, a hashed index has no order to follow
+    //////
+    template <typename Index, typename Row>
+    inline auto
+    sort_by_index(const Index& index, std::vector<Row>& rows, int)
+      -> decltype(index.key_comp(), void()) {
+
+      auto key = index.key_extractor();
+      auto comp = index.key_comp();
+      auto less = [&key, &comp](const Row& a, const Row& b) {
+        return comp(key(a), key(b));
+      };
+      if (std::is_sorted(rows.begin(), rows.end(), less)) {
+        return;
+      }
+      std::stable_sort(rows.begin(), rows.end(), less);
+    }
+
+    template <typename Index, typename Row>
+    inline void
+    sort_by_index(const Index&, std::vector<Row>&, long) {
+    }
+  }
+
+  //////
+  /// inserts fetched rows into a multi-index table in one pass, hashed
+  /// indices are sized for all rows upfront and rows go in the order of
+  /// the first index with an end() hint so it appends instead of
+  /// searching, a row the table rejects is handed to reject
+  //////
+  template <typename Table, typename Row, typename Reject>
+  inline void
+  bulk_insert(Table& table, std::vector<Row>& rows, Reject reject) {
+
+    constexpr std::size_t count = boost::mpl::size<typename Table::index_type_list>::value;
+    detail::reserve_indices(table, table.size() + rows.size(),
+                            std::make_index_sequence<count>());
+    auto& first = table.template get<0>();
+    detail::sort_by_index(first, rows, 0);
+    for (auto& row : rows) {
+      std::size_t size = table.size();
+      first.insert(first.end(), row);
+      if (table.size() == size) {
+        reject(row);
+      }
+    }
+  }
+
+  template <typename Table, typename Row>
+  inline void
+  bulk_insert(Table& table, std::vector<Row>& rows) {
+    bulk_insert(table, rows, [](const Row&) {});
+  }
+
+}}
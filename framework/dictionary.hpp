@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class dictionary
+  ///
+  /// interns the values of one low-cardinality string field so rows hold
+  /// a 32 bit code, codes are handed out in first seen order and never
+  /// change or go away, code 0 is the empty string
+  ///
+  /// view and code are lock free, only interning a new value takes the
+  /// lock, codes are found through an open addressing table of codes
+  /// that only ever gains entries and is replaced by one twice its size
+  /// at half full, replaced tables are kept like the segments are
+  //////
+  class dictionary {
+  public:
+
+    //////
+    /// the code of a value that was never interned, it matches no row
+    //////
+    static constexpr std::uint32_t none = 0xffffffff;
+
+    //////
+    /// values per segment and segments, at most 4M values
+    //////
+    static constexpr std::size_t segment_bits = 10;
+    static constexpr std::size_t segment_size = std::size_t(1) << segment_bits;
+    static constexpr std::size_t segments = 4096;
+
+    dictionary();
+    ~dictionary();
+
+    dictionary(const dictionary&) = delete;
+    dictionary& operator=(const dictionary&) = delete;
+
+    //////
+    /// the code of value, interning it when new
+    //////
+    std::uint32_t intern(std::string_view value);
+
+    //////
+    /// the code of value or none, never interns
+    //////
+    std::uint32_t code(std::string_view value) const;
+
+    //////
+    /// the value of a code handed out by intern
+    //////
+    std::string_view view(std::uint32_t code) const;
+
+    //////
+    /// distinct values interned
+    //////
+    std::size_t size() const;
+
+  private:
+
+    //////
+    /// codes by the hash of their value, none marks a free slot
+    //////
+    struct code_table {
+      explicit code_table(std::size_t capacity);
+      std::size_t                                  mask;
+      std::unique_ptr<std::atomic<std::uint32_t>[]>  slots;
+    };
+
+    //////
+    /// adds a code whose view is set to table, lock_ must be held
+    //////
+    void place(code_table& table, std::uint32_t code);
+
+    //////
+    /// class members
+    //////
+    std::deque<std::string>                            values_;
+    std::vector<std::unique_ptr<code_table>>           tables_;
+    std::atomic<code_table*>                           codes_;
+    std::unique_ptr<std::atomic<std::string_view*>[]>  segments_;
+    std::atomic<std::uint32_t>                         size_;
+    std::mutex                                         lock_;
+  };
+
+  inline
+  dictionary::code_table::
+  code_table(std::size_t capacity) :
+    mask(capacity - 1),
+    slots(new std::atomic<std::uint32_t>[capacity]) {
+
+    for (std::size_t i = 0; i < capacity; ++i) {
+      slots[i].store(none, std::memory_order_relaxed);
+    }
+  }
+
+  inline
+  dictionary::
+  dictionary() :
+    segments_(new std::atomic<std::string_view*>[segments]),
+    size_(0) {
+
+    for (std::size_t i = 0; i < segments; ++i) {
+      segments_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    tables_.emplace_back(new code_table(64));
+    codes_.store(tables_.back().get(), std::memory_order_release);
+    intern(std::string_view());
+  }
+
+  inline
+  dictionary::
+  ~dictionary() {
+    for (std::size_t i = 0; i < segments; ++i) {
+      delete[] segments_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  inline std::uint32_t
+  dictionary::
+  intern(std::string_view value) {
+
+    std::uint32_t found = code(value);
+    if (found != none) {
+      return found;
+    }
+    std::lock_guard<std::mutex>  guard(lock_);
+    found = code(value);
+    if (found != none) {
+      return found;
+    }
+    std::uint32_t code = size_.load(std::memory_order_relaxed);
+    if (code >= segments * segment_size) {
+      throw std::length_error("dictionary: too many values");
+    }
+    std::size_t segment = code >> segment_bits;
+    std::string_view* views = segments_[segment].load(std::memory_order_relaxed);
+    if (! views) {
+      views = new std::string_view[segment_size];
+      segments_[segment].store(views, std::memory_order_release);
+    }
+    values_.emplace_back(value);
+    views[code & (segment_size - 1)] = std::string_view(values_.back());
+
+    code_table* table = codes_.load(std::memory_order_relaxed);
+    if ((std::size_t(code) + 1) * 2 > table->mask + 1) {
+      tables_.emplace_back(new code_table((table->mask + 1) * 2));
+      table = tables_.back().get();
+      for (std::uint32_t c = 0; c < code; ++c) {
+        place(*table, c);
+      }
+      codes_.store(table, std::memory_order_release);
+    }
+    place(*table, code);
+    size_.store(code + 1, std::memory_order_release);
+    return code;
+  }
+
+  inline std::uint32_t
+  dictionary::
+  code(std::string_view value) const {
+
+    const code_table* table = codes_.load(std::memory_order_acquire);
+    std::size_t i = std::hash<std::string_view>()(value) & table->mask;
+    for (;; i = (i + 1) & table->mask) {
+      std::uint32_t c = table->slots[i].load(std::memory_order_acquire);
+      if (c == none || view(c) == value) {
+        return c;
+      }
+    }
+  }
+
+  inline void
+  dictionary::
+  place(code_table& table, std::uint32_t code) {
+
+    std::size_t i = std::hash<std::string_view>()(view(code)) & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != none) {
+      i = (i + 1) & table.mask;
+    }
+    table.slots[i].store(code, std::memory_order_release);
+  }
+
+  inline std::string_view
+  dictionary::
+  view(std::uint32_t code) const {
+    return segments_[code >> segment_bits].load(std::memory_order_acquire)
+             [code & (segment_size - 1)];
+  }
+
+  inline std::size_t
+  dictionary::
+  size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+
+}}
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class epoch_domain
+  ///
+  /// epoch based reclamation for tables read through raw pointers, a
+  /// reader announces the global epoch in its own slot while inside an
+  /// epoch_guard, a retired object is released once no reader announced
+  /// an epoch at or before the one it was retired in, by the next retire
+  /// or by a reclaimer thread that retire starts and that polls while
+  /// anything is held back, so callers need not collect themselves and
+  /// readers never destroy a table
+  //////
+  class epoch_domain {
+  public:
+
+    //////
+    /// most threads that may hold a guard at the same time
+    //////
+    static constexpr std::size_t max_readers = 256;
+
+    //////
+    /// the process wide domain
+    //////
+    static epoch_domain& instance();
+
+    //////
+    /// reader section entry and exit, nested sections share a slot, both
+    /// are a store to the slot and take no lock
+    //////
+    void enter();
+    void leave();
+
+    //////
+    /// keeps the object alive until every reader that may still see it
+    /// has left, call only after the object was unpublished
+    //////
+    void retire(std::shared_ptr<const void> object);
+
+    //////
+    /// releases retired objects no reader can see any more
+    //////
+    void collect();
+
+  private:
+
+    //////
+    /// how often the reclaimer looks again while objects are held back
+    //////
+    static constexpr std::chrono::milliseconds reclaim_period{1};
+
+    //////
+    /// default constructor and destructor, the destructor stops and
+    /// joins the reclaimer
+    //////
+    epoch_domain();
+    ~epoch_domain();
+
+    //////
+    /// a reader slot, 0 when idle, otherwise the announced epoch
+    //////
+    struct alignas(64) slot {
+      std::atomic<std::uint64_t>  epoch;
+      std::atomic<bool>           owned;
+    };
+
+    //////
+    /// claims a slot for the calling thread, released when the thread exits
+    //////
+    void claim();
+
+    //////
+    /// releases retired objects older than the oldest active reader,
+    /// lock_ must be held
+    //////
+    void collect_locked();
+
+    //////
+    /// the reclaimer thread, waits while nothing is held back
+    //////
+    void reclaim();
+
+    //////
+    /// retired objects with the epoch they were retired in
+    //////
+    using retired = std::vector<std::pair<std::uint64_t, std::shared_ptr<const void>>>;
+
+    //////
+    /// class members
+    //////
+    std::atomic<std::uint64_t>     epoch_;
+    std::array<slot, max_readers>  slots_;
+    retired                        retired_;
+    std::mutex                     lock_;
+    std::condition_variable        wake_;
+    bool                           stopping_;
+    std::thread                    reclaimer_;
+  };
+
+  //////
+  /// class epoch_guard
+  ///
+  /// RAII reader section, raw pointers obtained from a table inside the
+  /// guard stay valid until the guard is destroyed
+  //////
+  class epoch_guard {
+  public:
+
+    //////
+    /// constructor and destructor
+    //////
+    epoch_guard();
+    ~epoch_guard();
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+  };
+
+  namespace detail {
+
+    //////
+    /// per thread slot ownership and guard nesting
+    //////
+    struct epoch_reader {
+      ~epoch_reader();
+      std::atomic<bool>*           owned = nullptr;
+      std::atomic<std::uint64_t>*  epoch = nullptr;
+      std::size_t                  depth = 0;
+    };
+
+    inline
+    epoch_reader::
+    ~epoch_reader() {
+      if (owned) {
+        epoch->store(0);
+        owned->store(false);
+      }
+    }
+
+    inline epoch_reader&
+    reader() {
+      thread_local epoch_reader reader_;
+      return reader_;
+    }
+  }
+
+  //////
+  /// default constructor
+  //////
+  inline
+  epoch_domain::
+  epoch_domain() :
+    epoch_(1),
+    stopping_(false) {
+    for (auto& s : slots_) {
+      s.epoch.store(0);
+      s.owned.store(false);
+    }
+  }
+
+  //////
+  /// destructor
+  //////
+  inline
+  epoch_domain::
+  ~epoch_domain() {
+    {
+      std::lock_guard<std::mutex>  guard(lock_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    if (reclaimer_.joinable()) {
+      reclaimer_.join();
+    }
+  }
+
+  //////
+  /// singleton accessor
+  //////
+  inline epoch_domain&
+  epoch_domain::
+  instance() {
+    static epoch_domain instance_;
+    return instance_;
+  }
+
+  //////
+  /// claim
+  //////
+  inline void
+  epoch_domain::
+  claim() {
+
+    detail::epoch_reader& r = detail::reader();
+    for (auto& s : slots_) {
+      bool idle = false;
+      if (s.owned.compare_exchange_strong(idle, true)) {
+        r.owned = &s.owned;
+        r.epoch = &s.epoch;
+        return;
+      }
+    }
+    throw std::runtime_error("epoch_domain: too many reader threads");
+  }
+
+  //////
+  /// reader section
+  //////
+
+  inline void
+  epoch_domain::
+  enter() {
+
+    detail::epoch_reader& r = detail::reader();
+    if (r.depth == 0) {
+      if (! r.epoch) {
+        claim();
+      }
+      r.epoch->store(epoch_.load());
+    }
+    ++r.depth;
+  }
+
+  inline void
+  epoch_domain::
+  leave() {
+
+    detail::epoch_reader& r = detail::reader();
+    if (--r.depth == 0) {
+      r.epoch->store(0);
+    }
+  }
+
+  //////
+  /// retire
+  //////
+  inline void
+  epoch_domain::
+  retire(std::shared_ptr<const void> object) {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    retired_.emplace_back(epoch_.fetch_add(1), std::move(object));
+    collect_locked();
+    if (retired_.empty()) {
+      return;
+    }
+    if (! reclaimer_.joinable()) {
+      reclaimer_ = std::thread(&epoch_domain::reclaim, this);
+    }
+    wake_.notify_one();
+  }
+
+  //////
+  /// collect
+  //////
+  inline void
+  epoch_domain::
+  collect() {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    collect_locked();
+  }
+
+  //////
+  /// reclaim
+  //////
+  inline void
+  epoch_domain::
+  reclaim() {
+
+    std::unique_lock<std::mutex>  guard(lock_);
+    while (! stopping_) {
+      if (retired_.empty()) {
+        wake_.wait(guard);
+      }
+      else {
+        wake_.wait_for(guard, reclaim_period);
+      }
+      collect_locked();
+    }
+  }
+
+  inline void
+  epoch_domain::
+  collect_locked() {
+
+    std::uint64_t oldest = UINT64_MAX;
+    for (auto& s : slots_) {
+      std::uint64_t e = s.epoch.load();
+      if (e != 0 && e < oldest) {
+        oldest = e;
+      }
+    }
+    auto p = retired_.begin();
+    while (p != retired_.end()) {
+      if (p->first < oldest) {
+        p = retired_.erase(p);
+      }
+      else {
+        ++p;
+      }
+    }
+  }
+
+  //////
+  /// epoch_guard
+  //////
+
+  inline
+  epoch_guard::
+  epoch_guard() {
+    epoch_domain::instance().enter();
+  }
+
+  inline
+  epoch_guard::
+  ~epoch_guard() {
+    epoch_domain::instance().leave();
+  }
+
+}}
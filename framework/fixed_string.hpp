@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class fixed_string
+  ///
+  /// inline character storage of capacity N with a length prefix, the
+  /// buffer keeps one spare byte so the database layer can write a
+  /// terminated value of up to N characters straight into data()
+  //////
+  template <std::size_t N>
+  class fixed_string {
+  public:
+
+    static_assert(N < 65536, "fixed_string capacity must fit a 16 bit length");
+
+    //////
+    /// the length prefix type
+    //////
+    using size_type = std::conditional_t<(N < 256), std::uint8_t, std::uint16_t>;
+
+    //////
+    /// constructors
+    //////
+    fixed_string();
+    fixed_string(std::string_view value);
+
+    //////
+    /// assignment, truncates to capacity
+    //////
+    fixed_string& operator=(std::string_view value);
+
+    //////
+    /// accessors
+    //////
+    std::string_view view() const;
+    operator std::string_view() const;
+    std::size_t size() const;
+    static constexpr std::size_t capacity();
+
+    //////
+    /// raw buffer for binding, call terminate() once it has been written
+    //////
+    char* data();
+    void terminate();
+
+  private:
+
+    //////
+    /// class members
+    //////
+    size_type  size_;
+    char       data_[N + 1];
+  };
+
+  //////
+  /// default constructor
+  //////
+  template <std::size_t N>
+  inline
+  fixed_string<N>::
+  fixed_string() :
+    size_(0),
+    data_() {
+  }
+
+  //////
+  /// value constructor
+  //////
+  template <std::size_t N>
+  inline
+  fixed_string<N>::
+  fixed_string(std::string_view value) :
+    size_(0),
+    data_() {
+    *this = value;
+  }
+
+  //////
+  /// assignment
+  //////
+  template <std::size_t N>
+  inline fixed_string<N>&
+  fixed_string<N>::
+  operator=(std::string_view value) {
+    std::size_t len = value.size() < N ? value.size() : N;
+    std::memcpy(data_, value.data(), len);
+    data_[len] = '\0';
+    size_ = static_cast<size_type>(len);
+    return *this;
+  }
+
+  //////
+  /// accessors
+  //////
+
+  template <std::size_t N>
+  inline std::string_view
+  fixed_string<N>::
+  view() const {
+    return std::string_view(data_, size_);
+  }
+
+  template <std::size_t N>
+  inline
+  fixed_string<N>::
+  operator std::string_view() const {
+    return view();
+  }
+
+  template <std::size_t N>
+  inline std::size_t
+  fixed_string<N>::
+  size() const {
+    return size_;
+  }
+
+  template <std::size_t N>
+  inline constexpr std::size_t
+  fixed_string<N>::
+  capacity() {
+    return N;
+  }
+
+  //////
+  /// raw buffer
+  //////
+
+  template <std::size_t N>
+  inline char*
+  fixed_string<N>::
+  data() {
+    return data_;
+  }
+
+  template <std::size_t N>
+  inline void
+  fixed_string<N>::
+  terminate() {
+    data_[N] = '\0';
+    size_ = static_cast<size_type>(::strnlen(data_, N));
+  }
+
+}}
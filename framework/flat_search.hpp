@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// branch-free lower bound over a sorted contiguous array, a vector
+  /// or anything else with data() and size(), below(x) answers whether
+  /// x orders before the key searched for, returns the position of the
+  /// first element not below the key
+  //////
+  template <typename Sorted, typename Below>
+  std::size_t branchless_lower_bound(const Sorted& sorted, Below below);
+
+  //////
+  /// branchless_lower_bound for count keys at once, below(i, x) answers
+  /// whether x orders before key i, the searches advance in lock step so
+  /// their cache misses overlap, position i is written to found[i]
+  //////
+  template <typename Sorted, typename Below>
+  void branchless_lower_bound_batch(const Sorted& sorted,
+                                    std::size_t count,
+                                    Below below,
+                                    std::size_t* found);
+
+  //////
+  /// lays a sorted vector out in eytzinger (breadth first) order, slot 0
+  /// is unused so the children of slot k are 2k and 2k + 1, the result
+  /// shares the allocator of the input
+  //////
+  template <typename T, typename A>
+  std::vector<T, A> eytzinger_layout(const std::vector<T, A>& sorted);
+
+  //////
+  /// lower bound over an eytzinger laid out array, returns the slot of
+  /// the first element not below the key or 0 when there is none
+  //////
+  template <typename Tree, typename Below>
+  std::size_t eytzinger_lower_bound(const Tree& tree, Below below);
+
+  //////
+  /// eytzinger_lower_bound for count keys at once, as above
+  //////
+  template <typename Tree, typename Below>
+  void eytzinger_lower_bound_batch(const Tree& tree,
+                                   std::size_t count,
+                                   Below below,
+                                   std::size_t* found);
+
+  //////
+  /// number of searches a batch advances in lock step
+  //////
+  constexpr std::size_t search_group = 16;
+
+  //////
+  /// branchless_lower_bound
+  //////
+  template <typename Sorted, typename Below>
+  inline std::size_t
+  branchless_lower_bound(const Sorted& sorted, Below below) {
+
+    using T = typename Sorted::value_type;
+    std::size_t n = sorted.size();
+    if (n == 0) {
+      return 0;
+    }
+    const T* base = sorted.data();
+    while (n > 1) {
+      std::size_t half = n / 2;
+      base = below(base[half - 1]) ? base + half : base;
+      n -= half;
+    }
+    return (base - sorted.data()) + (below(*base) ? 1 : 0);
+  }
+
+  //////
+  /// branchless_lower_bound_batch
+  //////
+  template <typename Sorted, typename Below>
+  inline void
+  branchless_lower_bound_batch(const Sorted& sorted,
+                               std::size_t count,
+                               Below below,
+                               std::size_t* found) {
+
+    using T = typename Sorted::value_type;
+    const T* data = sorted.data();
+    for (std::size_t first = 0; first < count; first += search_group) {
+      std::size_t group = std::min(search_group, count - first);
+      if (sorted.empty()) {
+        std::fill(found + first, found + first + group, 0);
+        continue;
+      }
+      const T* base[search_group];
+      std::fill(base, base + group, data);
+      std::size_t n = sorted.size();
+      while (n > 1) {
+        std::size_t half = n / 2;
+        for (std::size_t g = 0; g < group; ++g) {
+          base[g] = below(first + g, base[g][half - 1]) ? base[g] + half : base[g];
+        }
+        n -= half;
+      }
+      for (std::size_t g = 0; g < group; ++g) {
+        found[first + g] = (base[g] - data) + (below(first + g, *base[g]) ? 1 : 0);
+      }
+    }
+  }
+
+  namespace detail {
+
+    template <typename T, typename A>
+    inline std::size_t
+    eytzinger_fill(const std::vector<T, A>& sorted,
+                   std::vector<T, A>& tree,
+                   std::size_t i,
+                   std::size_t k) {
+
+      if (k < tree.size()) {
+        i = eytzinger_fill(sorted, tree, i, 2 * k);
+        tree[k] = sorted[i++];
+        i = eytzinger_fill(sorted, tree, i, 2 * k + 1);
+      }
+      return i;
+    }
+  }
+
+  //////
+  /// eytzinger_layout
+  //////
+  template <typename T, typename A>
+  inline std::vector<T, A>
+  eytzinger_layout(const std::vector<T, A>& sorted) {
+
+    std::vector<T, A> tree(sorted.size() + 1, T(), sorted.get_allocator());
+    detail::eytzinger_fill(sorted, tree, 0, 1);
+    return tree;
+  }
+
+  //////
+  /// eytzinger_lower_bound
+  //////
+  template <typename Tree, typename Below>
+  inline std::size_t
+  eytzinger_lower_bound(const Tree& tree, Below below) {
+
+    std::size_t n = tree.empty() ? 0 : tree.size() - 1;
+    std::size_t k = 1;
+    while (k <= n) {
+#if defined(__GNUC__)
+      if (16 * k <= n) {
+        __builtin_prefetch(tree.data() + 16 * k);
+      }
+#endif
+      k = 2 * k + (below(tree[k]) ? 1 : 0);
+    }
+    // strip the trailing right turns plus the final left turn
+    while (k & 1) {
+      k >>= 1;
+    }
+    return k >> 1;
+  }
+
+  //////
+  /// eytzinger_lower_bound_batch
+  //////
+  template <typename Tree, typename Below>
+  inline void
+  eytzinger_lower_bound_batch(const Tree& tree,
+                              std::size_t count,
+                              Below below,
+                              std::size_t* found) {
+
+    std::size_t n = tree.empty() ? 0 : tree.size() - 1;
+    for (std::size_t first = 0; first < count; first += search_group) {
+      std::size_t group = std::min(search_group, count - first);
+      std::size_t k[search_group];
+      std::fill(k, k + group, 1);
+      // one pass per tree level, searches that fell off early sit out
+      for (std::size_t level = 1; level <= n; level *= 2) {
+        for (std::size_t g = 0; g < group; ++g) {
+          if (k[g] <= n) {
+#if defined(__GNUC__)
+            if (16 * k[g] <= n) {
+              __builtin_prefetch(tree.data() + 16 * k[g]);
+            }
+#endif
+            k[g] = 2 * k[g] + (below(first + g, tree[k[g]]) ? 1 : 0);
+          }
+        }
+      }
+      for (std::size_t g = 0; g < group; ++g) {
+        while (k[g] & 1) {
+          k[g] >>= 1;
+        }
+        found[first + g] = k[g] >> 1;
+      }
+    }
+  }
+
+}}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// the 64 bit finalizer of murmur3, every input bit reaches every
+  /// output bit so a prime bucket count sees well spread values
+  //////
+  constexpr std::uint64_t
+  hash_mix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  //////
+  /// class fast_hash
+  ///
+  /// non-cryptographic hash of one key field, strings are read eight
+  /// bytes at a time and numbers hash by value, so a string, string view
+  /// or fixed string with the same characters hash the same
+  //////
+  struct fast_hash {
+
+    std::size_t operator()(std::string_view value) const noexcept;
+
+    template <typename T,
+              typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    std::size_t operator()(T value) const noexcept;
+  };
+
+  inline std::size_t
+  fast_hash::
+  operator()(std::string_view value) const noexcept {
+
+    const char* p = value.data();
+    std::size_t n = value.size();
+    std::uint64_t h = 0x9e3779b97f4a7c15ull ^ n;
+    for (; n >= 8; p += 8, n -= 8) {
+      std::uint64_t word;
+      std::memcpy(&word, p, 8);
+      h = (h ^ hash_mix(word)) * 0x100000001b3ull;
+    }
+    if (n) {
+      std::uint64_t word = 0;
+      std::memcpy(&word, p, n);
+      h = (h ^ hash_mix(word)) * 0x100000001b3ull;
+    }
+    return static_cast<std::size_t>(hash_mix(h));
+  }
+
+  template <typename T, typename>
+  inline std::size_t
+  fast_hash::
+  operator()(T value) const noexcept {
+
+    std::uint64_t word = 0;
+    if (std::is_floating_point<T>::value) {
+      // +0.0 and -0.0 compare equal and must hash equal
+      if (value == T(0)) {
+        value = T(0);
+      }
+      std::memcpy(&word, &value, sizeof(T));
+    }
+    else {
+      word = static_cast<std::uint64_t>(value);
+    }
+    return static_cast<std::size_t>(hash_mix(word));
+  }
+
+}}
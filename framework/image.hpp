@@ -0,0 +1,400 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// table images, numbers in host byte order
+  ///
+  ///   header    magic, format, schema hash, row size, row count and
+  ///             the number of sections
+  ///   offsets   per section its offset and length in bytes
+  ///   sections  plain arrays each aligned to image_alignment, the rows
+  ///             first and then one row id array per index
+  ///
+  /// an image holds no pointers, so the same bytes serve from the heap
+  /// or mapped read only from a file whose pages every process shares
+  //////
+  constexpr std::uint32_t image_magic     = 0x474d4952;
+  constexpr std::uint32_t image_format    = 1;
+  constexpr std::size_t   image_alignment = 64;
+
+  struct image_header {
+    std::uint32_t  magic;
+    std::uint32_t  format;
+    std::uint64_t  schema;
+    std::uint64_t  row_size;
+    std::uint64_t  rows;
+    std::uint64_t  sections;
+  };
+
+  struct image_section {
+    std::uint64_t  offset;
+    std::uint64_t  length;
+  };
+
+  //////
+  /// class image_array
+  ///
+  /// a read only array inside an image, it does not keep the image alive
+  //////
+  template <typename T>
+  class image_array {
+  public:
+
+    using value_type = T;
+
+    image_array();
+    image_array(const T* data, std::size_t size);
+
+    const T* data() const;
+    std::size_t size() const;
+    bool empty() const;
+    const T& operator[](std::size_t i) const;
+    const T* begin() const;
+    const T* end() const;
+
+  private:
+
+    const T*     data_;
+    std::size_t  size_;
+  };
+
+  //////
+  /// class image
+  ///
+  /// the bytes of one image, built on the heap or mapped from a file,
+  /// opening a file only checks its header and section bounds so it
+  /// costs the same for any number of rows
+  //////
+  class image {
+  public:
+
+    using section = std::pair<const void*, std::size_t>;
+
+    //////
+    /// lays the sections out as a new heap image
+    //////
+    static std::shared_ptr<const image> build(std::uint64_t schema,
+                                              std::uint64_t row_size,
+                                              std::uint64_t rows,
+                                              const std::vector<section>& sections);
+
+    //////
+    /// maps a file read only, nullptr when it cannot be mapped or was
+    /// not written for this schema, row size and number of sections
+    //////
+    static std::shared_ptr<const image> map(const std::string& path,
+                                            std::uint64_t schema,
+                                            std::uint64_t row_size,
+                                            std::size_t sections);
+
+    //////
+    /// reads an image out of bytes that owner keeps alive, nullptr when
+    /// they were not written for this schema, row size and sections
+    //////
+    static std::shared_ptr<const image> view(const void* data,
+                                             std::size_t size,
+                                             std::uint64_t schema,
+                                             std::uint64_t row_size,
+                                             std::size_t sections,
+                                             std::shared_ptr<const void> owner);
+
+    ~image();
+
+    image(const image&) = delete;
+    image& operator=(const image&) = delete;
+
+    //////
+    /// rows and sections, a section that does not hold whole aligned
+    /// elements of T comes back empty
+    //////
+    std::uint64_t rows() const;
+    const char* data() const;
+    std::size_t size() const;
+    template <typename T>
+    image_array<T> get(std::size_t section) const;
+
+    //////
+    /// writes the image to path.tmp and renames it over path
+    //////
+    bool save(const std::string& path) const;
+
+  private:
+
+    image();
+
+    bool valid(std::uint64_t schema, std::uint64_t row_size, std::size_t sections) const;
+    const image_header& header() const;
+
+    //////
+    /// class members
+    //////
+    std::vector<char>            heap_;
+    const char*                  data_;
+    std::size_t                  size_;
+    void*                        mapped_;
+    std::shared_ptr<const void>  owner_;
+  };
+
+  //////
+  /// image_array
+  //////
+
+  template <typename T>
+  inline
+  image_array<T>::
+  image_array() :
+    data_(nullptr),
+    size_(0) {
+  }
+
+  template <typename T>
+  inline
+  image_array<T>::
+  image_array(const T* data, std::size_t size) :
+    data_(data),
+    size_(size) {
+  }
+
+  template <typename T>
+  inline const T*
+  image_array<T>::
+  data() const {
+    return data_;
+  }
+
+  template <typename T>
+  inline std::size_t
+  image_array<T>::
+  size() const {
+    return size_;
+  }
+
+  template <typename T>
+  inline bool
+  image_array<T>::
+  empty() const {
+    return size_ == 0;
+  }
+
+  template <typename T>
+  inline const T&
+  image_array<T>::
+  operator[](std::size_t i) const {
+    return data_[i];
+  }
+
+  template <typename T>
+  inline const T*
+  image_array<T>::
+  begin() const {
+    return data_;
+  }
+
+  template <typename T>
+  inline const T*
+  image_array<T>::
+  end() const {
+    return data_ + size_;
+  }
+
+  //////
+  /// image
+  //////
+
+  inline
+  image::
+  image() :
+    data_(nullptr),
+    size_(0),
+    mapped_(nullptr) {
+  }
+
+  inline
+  image::
+  ~image() {
+    if (mapped_) {
+      ::munmap(mapped_, size_);
+    }
+  }
+
+  inline std::shared_ptr<const image>
+  image::
+  build(std::uint64_t schema,
+        std::uint64_t row_size,
+        std::uint64_t rows,
+        const std::vector<section>& sections) {
+
+    auto align = [](std::size_t n) {
+      return (n + image_alignment - 1) / image_alignment * image_alignment;
+    };
+    std::vector<image_section> offsets(sections.size());
+    std::size_t size = align(sizeof(image_header) + sections.size() * sizeof(image_section));
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+      offsets[i].offset = size;
+      offsets[i].length = sections[i].second;
+      size = align(size + sections[i].second);
+    }
+
+    std::shared_ptr<image> built(new image());
+    built->heap_.assign(size, '\0');
+    image_header header{image_magic, image_format, schema, row_size, rows, sections.size()};
+    char* data = built->heap_.data();
+    std::memcpy(data, &header, sizeof(header));
+    if (! offsets.empty()) {
+      std::memcpy(data + sizeof(header), offsets.data(), offsets.size() * sizeof(image_section));
+    }
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+      if (sections[i].second) {
+        std::memcpy(data + offsets[i].offset, sections[i].first, sections[i].second);
+      }
+    }
+    built->data_ = data;
+    built->size_ = size;
+    return built;
+  }
+
+  inline std::shared_ptr<const image>
+  image::
+  map(const std::string& path,
+      std::uint64_t schema,
+      std::uint64_t row_size,
+      std::size_t sections) {
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      mapped = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+      return nullptr;
+    }
+
+    std::shared_ptr<image> opened(new image());
+    opened->mapped_ = mapped;
+    opened->data_ = static_cast<const char*>(mapped);
+    opened->size_ = static_cast<std::size_t>(st.st_size);
+    if (! opened->valid(schema, row_size, sections)) {
+      return nullptr;
+    }
+    return opened;
+  }
+
+  inline std::shared_ptr<const image>
+  image::
+  view(const void* data,
+       std::size_t size,
+       std::uint64_t schema,
+       std::uint64_t row_size,
+       std::size_t sections,
+       std::shared_ptr<const void> owner) {
+
+    std::shared_ptr<image> viewed(new image());
+    viewed->data_ = static_cast<const char*>(data);
+    viewed->size_ = size;
+    viewed->owner_ = std::move(owner);
+    if (! viewed->valid(schema, row_size, sections)) {
+      return nullptr;
+    }
+    return viewed;
+  }
+
+  inline std::uint64_t
+  image::
+  rows() const {
+    return header().rows;
+  }
+
+  inline const char*
+  image::
+  data() const {
+    return data_;
+  }
+
+  inline std::size_t
+  image::
+  size() const {
+    return size_;
+  }
+
+  template <typename T>
+  inline image_array<T>
+  image::
+  get(std::size_t section) const {
+
+    image_section s;
+    std::memcpy(&s, data_ + sizeof(image_header) + section * sizeof(image_section), sizeof(s));
+    const char* p = data_ + s.offset;
+    if (s.length % sizeof(T) != 0 || reinterpret_cast<std::uintptr_t>(p) % alignof(T) != 0) {
+      return image_array<T>();
+    }
+    return image_array<T>(reinterpret_cast<const T*>(p), s.length / sizeof(T));
+  }
+
+  inline bool
+  image::
+  save(const std::string& path) const {
+
+    std::string temp = path + ".tmp";
+    {
+      std::ofstream ofs(temp, std::ios::binary | std::ios::trunc);
+      ofs.write(data_, size_);
+      if (! ofs.flush()) {
+        ofs.close();
+        std::remove(temp.c_str());
+        return false;
+      }
+    }
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+  }
+
+  inline bool
+  image::
+  valid(std::uint64_t schema, std::uint64_t row_size, std::size_t sections) const {
+
+    std::size_t table = sizeof(image_header) + sections * sizeof(image_section);
+    if (size_ < table) {
+      return false;
+    }
+    const image_header& h = header();
+    if (h.magic != image_magic || h.format != image_format || h.schema != schema ||
+        h.row_size != row_size || h.sections != sections) {
+      return false;
+    }
+    for (std::size_t i = 0; i < sections; ++i) {
+      image_section s;
+      std::memcpy(&s, data_ + sizeof(image_header) + i * sizeof(image_section), sizeof(s));
+      if (s.offset < table || s.offset > size_ || s.length > size_ - s.offset) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline const image_header&
+  image::
+  header() const {
+    return *reinterpret_cast<const image_header*>(data_);
+  }
+
+}}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class mpsc_queue
+  ///
+  /// unbounded lock-free queue for many producers and one consumer, a
+  /// push is one exchange and one store, T must be default constructible
+  /// for the stub node the queue starts with
+  //////
+  template <typename T>
+  class mpsc_queue {
+  public:
+
+    //////
+    /// constructor and destructor
+    //////
+    mpsc_queue();
+    ~mpsc_queue();
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    //////
+    /// any thread
+    //////
+    void push(T value);
+
+    //////
+    /// the consumer thread only, pop moves the oldest value into out
+    //////
+    bool pop(T& out);
+    bool empty() const;
+
+  private:
+
+    //////
+    /// a queued value, the consumer owns the node tail_ points at
+    //////
+    struct node {
+      std::atomic<node*>  next;
+      T                   value;
+    };
+
+    //////
+    /// class members, producers meet at head_, the consumer owns tail_
+    //////
+    alignas(64) std::atomic<node*>  head_;
+    alignas(64) node*               tail_;
+  };
+
+  //////
+  /// constructor
+  //////
+  template <typename T>
+  inline
+  mpsc_queue<T>::
+  mpsc_queue() :
+    head_(new node{{nullptr}, T()}),
+    tail_(head_.load()) {
+  }
+
+  //////
+  /// destructor
+  //////
+  template <typename T>
+  inline
+  mpsc_queue<T>::
+  ~mpsc_queue() {
+    while (tail_) {
+      node* next = tail_->next.load();
+      delete tail_;
+      tail_ = next;
+    }
+  }
+
+  //////
+  /// push, the link store is sequentially consistent so a consumer that
+  /// announces it is going idle and then finds the queue empty cannot
+  /// miss a producer that saw it busy
+  //////
+  template <typename T>
+  inline void
+  mpsc_queue<T>::
+  push(T value) {
+
+    node* n = new node{{nullptr}, std::move(value)};
+    node* prior = head_.exchange(n, std::memory_order_acq_rel);
+    prior->next.store(n);
+  }
+
+  //////
+  /// pop
+  //////
+  template <typename T>
+  inline bool
+  mpsc_queue<T>::
+  pop(T& out) {
+
+    node* next = tail_->next.load(std::memory_order_acquire);
+    if (! next) {
+      return false;
+    }
+    out = std::move(next->value);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+  //////
+  /// empty
+  //////
+  template <typename T>
+  inline bool
+  mpsc_queue<T>::
+  empty() const {
+    return tail_->next.load() == nullptr;
+  }
+
+}}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// rows per batch handed from the fetch to the build stage, and the
+  /// number of batches the ring between them holds
+  //////
+  constexpr std::size_t pipeline_batch = 1024;
+  constexpr std::size_t pipeline_depth = 8;
+
+  //////
+  /// per stage times of a pipelined load, a stage that spends much of
+  /// its time blocked is waiting on the other one
+  //////
+  struct load_stats {
+    std::size_t                          rows = 0;
+    std::size_t                          batches = 0;
+    std::chrono::steady_clock::duration  fetch{};
+    std::chrono::steady_clock::duration  fetch_blocked{};
+    std::chrono::steady_clock::duration  build{};
+    std::chrono::steady_clock::duration  build_blocked{};
+  };
+
+  //////
+  /// class spsc_ring
+  ///
+  /// bounded ring for one producer and one consumer, slots move through
+  /// two atomic counters, a side only takes the lock to sleep when the
+  /// ring is full or empty and the other side only to wake it
+  //////
+  template <typename T>
+  class spsc_ring {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    //////
+    /// constructor
+    //////
+    explicit spsc_ring(std::size_t capacity);
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    //////
+    /// the producer, push blocks while the ring is full and returns false
+    /// once the consumer cancelled, close follows the last push
+    //////
+    bool push(T value);
+    void close();
+
+    //////
+    /// the consumer gives up, a blocked push returns and every later one
+    /// fails, so the producer never waits on a consumer that has gone
+    //////
+    void cancel();
+
+    //////
+    /// the consumer, pop blocks while the ring is empty and returns false
+    /// once it is closed and drained
+    //////
+    bool pop(T& out);
+
+    //////
+    /// time each side spent blocked, read once both are done
+    //////
+    clock::duration push_blocked() const;
+    clock::duration pop_blocked() const;
+
+  private:
+
+    //////
+    /// wakes the other side if it announced it sleeps
+    //////
+    void wake(const std::atomic<bool>& sleeping);
+
+    //////
+    /// class members
+    //////
+    std::vector<T>                        slots_;
+    alignas(64) std::atomic<std::size_t>  head_;
+    alignas(64) std::atomic<std::size_t>  tail_;
+    std::atomic<bool>                     closed_;
+    std::atomic<bool>                     cancelled_;
+    std::atomic<bool>                     producer_sleeps_;
+    std::atomic<bool>                     consumer_sleeps_;
+    std::mutex                            lock_;
+    std::condition_variable               wake_;
+    clock::duration                       push_blocked_;
+    clock::duration                       pop_blocked_;
+  };
+
+  //////
+  /// class pipeline_fetcher
+  ///
+  /// runs the fetch stage of a pipelined load on its own thread and
+  /// closes the ring when it ends, an exception there is kept and
+  /// rethrown by join, the destructor cancels the ring and joins, so an
+  /// exception on the build side neither leaves the thread joinable nor
+  /// the fetch blocked on a full ring
+  //////
+  template <typename T>
+  class pipeline_fetcher {
+  public:
+
+    //////
+    /// constructor, starts fetch
+    //////
+    template <typename Fetch>
+    pipeline_fetcher(spsc_ring<T>& ring, Fetch fetch);
+
+    pipeline_fetcher(const pipeline_fetcher&) = delete;
+    pipeline_fetcher& operator=(const pipeline_fetcher&) = delete;
+
+    //////
+    /// destructor, cancels and joins a fetch not yet joined
+    //////
+    ~pipeline_fetcher();
+
+    //////
+    /// waits for the fetch and rethrows what it threw
+    //////
+    void join();
+
+  private:
+
+    //////
+    /// class members
+    //////
+    spsc_ring<T>&       ring_;
+    std::exception_ptr  error_;
+    std::thread         thread_;
+  };
+
+  //////
+  /// constructor
+  //////
+  template <typename T>
+  inline
+  spsc_ring<T>::
+  spsc_ring(std::size_t capacity) :
+    slots_(capacity ? capacity : 1),
+    head_(0),
+    tail_(0),
+    closed_(false),
+    cancelled_(false),
+    producer_sleeps_(false),
+    consumer_sleeps_(false),
+    push_blocked_(clock::duration::zero()),
+    pop_blocked_(clock::duration::zero()) {
+  }
+
+  //////
+  /// producer
+  //////
+
+  template <typename T>
+  inline bool
+  spsc_ring<T>::
+  push(T value) {
+
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load() == slots_.size()) {
+      clock::time_point start = clock::now();
+      std::unique_lock<std::mutex>  guard(lock_);
+      producer_sleeps_.store(true);
+      wake_.wait(guard, [this, tail] {
+        return tail - head_.load() < slots_.size() || cancelled_.load();
+      });
+      producer_sleeps_.store(false);
+      push_blocked_ += clock::now() - start;
+    }
+    if (cancelled_.load()) {
+      return false;
+    }
+    slots_[tail % slots_.size()] = std::move(value);
+    tail_.store(tail + 1);
+    wake(consumer_sleeps_);
+    return true;
+  }
+
+  template <typename T>
+  inline void
+  spsc_ring<T>::
+  close() {
+    std::lock_guard<std::mutex>  guard(lock_);
+    closed_.store(true);
+    wake_.notify_all();
+  }
+
+  //////
+  /// consumer
+  //////
+
+  template <typename T>
+  inline void
+  spsc_ring<T>::
+  cancel() {
+    std::lock_guard<std::mutex>  guard(lock_);
+    cancelled_.store(true);
+    wake_.notify_all();
+  }
+
+  template <typename T>
+  inline bool
+  spsc_ring<T>::
+  pop(T& out) {
+
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load()) {
+      clock::time_point start = clock::now();
+      std::unique_lock<std::mutex>  guard(lock_);
+      consumer_sleeps_.store(true);
+      wake_.wait(guard, [this, head] { return head != tail_.load() || closed_.load(); });
+      consumer_sleeps_.store(false);
+      pop_blocked_ += clock::now() - start;
+      if (head == tail_.load()) {
+        return false;
+      }
+    }
+    out = std::move(slots_[head % slots_.size()]);
+    head_.store(head + 1);
+    wake(producer_sleeps_);
+    return true;
+  }
+
+  //////
+  /// blocked times
+  //////
+
+  template <typename T>
+  inline typename spsc_ring<T>::clock::duration
+  spsc_ring<T>::
+  push_blocked() const {
+    return push_blocked_;
+  }
+
+  template <typename T>
+  inline typename spsc_ring<T>::clock::duration
+  spsc_ring<T>::
+  pop_blocked() const {
+    return pop_blocked_;
+  }
+
+  //////
+  /// pipeline_fetcher
+  //////
+
+  template <typename T>
+  template <typename Fetch>
+  inline
+  pipeline_fetcher<T>::
+  pipeline_fetcher(spsc_ring<T>& ring, Fetch fetch) :
+    ring_(ring),
+    thread_([this, fetch] {
+      try {
+        fetch();
+      }
+      catch (...) {
+        error_ = std::current_exception();
+      }
+      ring_.close();
+    }) {
+  }
+
+  template <typename T>
+  inline
+  pipeline_fetcher<T>::
+  ~pipeline_fetcher() {
+    if (thread_.joinable()) {
+      ring_.cancel();
+      thread_.join();
+    }
+  }
+
+  template <typename T>
+  inline void
+  pipeline_fetcher<T>::
+  join() {
+    thread_.join();
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  //////
+  /// wake
+  //////
+  template <typename T>
+  inline void
+  spsc_ring<T>::
+  wake(const std::atomic<bool>& sleeping) {
+    if (sleeping.load()) {
+      std::lock_guard<std::mutex>  guard(lock_);
+      wake_.notify_all();
+    }
+  }
+
+}}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class range
+  ///
+  /// a pair of iterators together with whatever keeps what they point
+  /// into valid, a snapshot of the table or a copy of the matching row
+  /// handles, iteration yields the stored row handles without copying them
+  //////
+  template <typename Iterator, typename Owner>
+  class range {
+  public:
+
+    using iterator = Iterator;
+
+    //////
+    /// constructor
+    //////
+    range(Iterator first, Iterator last, Owner owner);
+
+    //////
+    /// iteration
+    //////
+    Iterator begin() const;
+    Iterator end() const;
+
+    //////
+    /// emptiness is constant time, size walks the range
+    //////
+    bool empty() const;
+    std::size_t size() const;
+
+  private:
+
+    //////
+    /// class members
+    //////
+    Owner     owner_;
+    Iterator  first_;
+    Iterator  last_;
+  };
+
+  //////
+  /// constructor
+  //////
+  template <typename Iterator, typename Owner>
+  inline
+  range<Iterator, Owner>::
+  range(Iterator first, Iterator last, Owner owner) :
+    owner_(std::move(owner)),
+    first_(first),
+    last_(last) {
+  }
+
+  //////
+  /// iteration
+  //////
+
+  template <typename Iterator, typename Owner>
+  inline Iterator
+  range<Iterator, Owner>::
+  begin() const {
+    return first_;
+  }
+
+  template <typename Iterator, typename Owner>
+  inline Iterator
+  range<Iterator, Owner>::
+  end() const {
+    return last_;
+  }
+
+  //////
+  /// size
+  //////
+
+  template <typename Iterator, typename Owner>
+  inline bool
+  range<Iterator, Owner>::
+  empty() const {
+    return first_ == last_;
+  }
+
+  template <typename Iterator, typename Owner>
+  inline std::size_t
+  range<Iterator, Owner>::
+  size() const {
+    return std::distance(first_, last_);
+  }
+
+}}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class periodic_refresher
+  ///
+  /// runs a task on its own thread every period, shifted by a random
+  /// amount within plus or minus jitter so mappings started together
+  /// do not hit the database together, destruction stops and joins
+  //////
+  class periodic_refresher {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    //////
+    /// constructor and destructor, the first run is one period away
+    //////
+    periodic_refresher(clock::duration period,
+                       clock::duration jitter,
+                       std::function<void()> task);
+    ~periodic_refresher();
+
+    periodic_refresher(const periodic_refresher&) = delete;
+    periodic_refresher& operator=(const periodic_refresher&) = delete;
+
+  private:
+
+    //////
+    /// the refresher thread
+    //////
+    void run();
+
+    //////
+    /// period plus a random offset within the jitter, never negative
+    //////
+    clock::duration next_delay();
+
+    //////
+    /// class members, the thread last so it starts once all else is set
+    //////
+    clock::duration          period_;
+    clock::duration          jitter_;
+    std::function<void()>    task_;
+    std::minstd_rand         random_;
+    std::mutex               lock_;
+    std::condition_variable  wake_;
+    bool                     stopping_;
+    std::thread              thread_;
+  };
+
+  //////
+  /// constructor
+  //////
+  inline
+  periodic_refresher::
+  periodic_refresher(clock::duration period,
+                     clock::duration jitter,
+                     std::function<void()> task) :
+    period_(period),
+    jitter_(jitter),
+    task_(std::move(task)),
+    random_(std::random_device()()),
+    stopping_(false),
+    thread_(&periodic_refresher::run, this) {
+  }
+
+  //////
+  /// destructor
+  //////
+  inline
+  periodic_refresher::
+  ~periodic_refresher() {
+    {
+      std::lock_guard<std::mutex>  guard(lock_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+  }
+
+  //////
+  /// run
+  //////
+  inline void
+  periodic_refresher::
+  run() {
+
+    std::unique_lock<std::mutex>  guard(lock_);
+    while (! wake_.wait_for(guard, next_delay(), [this] { return stopping_; })) {
+      guard.unlock();
+      try {
+        task_();
+      }
+      catch (...) {
+        // a failed refresh is retried on the next period
+      }
+      guard.lock();
+    }
+  }
+
+  //////
+  /// next_delay
+  //////
+  inline periodic_refresher::clock::duration
+  periodic_refresher::
+  next_delay() {
+
+    if (jitter_ <= clock::duration::zero()) {
+      return period_;
+    }
+    std::uniform_int_distribution<clock::rep> offset(-jitter_.count(), jitter_.count());
+    clock::duration delay = period_ + clock::duration(offset(random_));
+    return delay > clock::duration::zero() ? delay : clock::duration::zero();
+  }
+
+}}
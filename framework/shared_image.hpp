@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <framework/image.hpp>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// images shared between processes, one loader publishes under a name
+  /// and any number of readers follow it
+  ///
+  ///   name      control object holding the last published generation
+  ///   name.N    the image of generation N
+  ///
+  /// a generation is written in full before its number is published and
+  /// the one before is removed after, a reader that mapped it keeps its
+  /// pages until it lets go, so neither side ever waits on the other
+  //////
+  struct shared_control {
+    std::atomic<std::uint64_t>  generation;
+  };
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "the generation is read across processes");
+
+  inline std::string
+  shared_generation(const std::string& name, std::uint64_t generation) {
+    return name + "." + std::to_string(generation);
+  }
+
+  //////
+  /// copies an image into the next generation of name and publishes it,
+  /// only one process may publish under a name
+  //////
+  inline bool
+  publish_image(const std::string& name, const image& img) {
+
+    namespace bip = boost::interprocess;
+    try {
+      bip::shared_memory_object control(bip::open_or_create, name.c_str(), bip::read_write);
+      bip::offset_t size = 0;
+      if (! control.get_size(size) || size < static_cast<bip::offset_t>(sizeof(shared_control))) {
+        control.truncate(sizeof(shared_control));
+      }
+      bip::mapped_region region(control, bip::read_write, 0, sizeof(shared_control));
+      auto* published = static_cast<shared_control*>(region.get_address());
+
+      std::uint64_t prior = published->generation.load();
+      std::string next = shared_generation(name, prior + 1);
+      bip::shared_memory_object::remove(next.c_str());
+      {
+        bip::shared_memory_object object(bip::create_only, next.c_str(), bip::read_write);
+        object.truncate(img.size());
+        bip::mapped_region bytes(object, bip::read_write);
+        std::memcpy(bytes.get_address(), img.data(), img.size());
+      }
+      published->generation.store(prior + 1);
+      if (prior) {
+        bip::shared_memory_object::remove(shared_generation(name, prior).c_str());
+      }
+      return true;
+    }
+    catch (const bip::interprocess_exception&) {
+      return false;
+    }
+  }
+
+  //////
+  /// removes name and its published generation, readers that follow it
+  /// keep the generation they mapped
+  //////
+  inline void
+  remove_shared(const std::string& name) {
+
+    namespace bip = boost::interprocess;
+    try {
+      bip::shared_memory_object control(bip::open_only, name.c_str(), bip::read_only);
+      bip::mapped_region region(control, bip::read_only, 0, sizeof(shared_control));
+      auto* published = static_cast<const shared_control*>(region.get_address());
+      bip::shared_memory_object::remove(
+        shared_generation(name, published->generation.load()).c_str());
+    }
+    catch (const bip::interprocess_exception&) {
+    }
+    bip::shared_memory_object::remove(name.c_str());
+  }
+
+  //////
+  /// class shared_follower
+  ///
+  /// a reader of the generations published under one name, checking for
+  /// a new generation is a single atomic load
+  //////
+  class shared_follower {
+  public:
+
+    explicit shared_follower(const std::string& name);
+
+    //////
+    /// whether name has been published to
+    //////
+    explicit operator bool() const;
+
+    //////
+    /// the last published generation, 0 before the first
+    //////
+    std::uint64_t generation() const;
+
+    //////
+    /// maps a generation read only, nullptr once it has been removed or
+    /// when it was not written for this schema, row size and sections
+    //////
+    std::shared_ptr<const image> open(std::uint64_t generation,
+                                      std::uint64_t schema,
+                                      std::uint64_t row_size,
+                                      std::size_t sections) const;
+
+  private:
+
+    //////
+    /// class members
+    //////
+    std::string                                          name_;
+    std::unique_ptr<boost::interprocess::mapped_region>  control_;
+  };
+
+  inline
+  shared_follower::
+  shared_follower(const std::string& name) :
+    name_(name) {
+
+    namespace bip = boost::interprocess;
+    try {
+      bip::shared_memory_object control(bip::open_only, name.c_str(), bip::read_only);
+      bip::offset_t size = 0;
+      if (control.get_size(size) && size >= static_cast<bip::offset_t>(sizeof(shared_control))) {
+        control_.reset(new bip::mapped_region(control, bip::read_only, 0, sizeof(shared_control)));
+      }
+    }
+    catch (const bip::interprocess_exception&) {
+    }
+  }
+
+  inline
+  shared_follower::
+  operator bool() const {
+    return control_ && generation() != 0;
+  }
+
+  inline std::uint64_t
+  shared_follower::
+  generation() const {
+    if (! control_) {
+      return 0;
+    }
+    return static_cast<const shared_control*>(control_->get_address())->generation.load();
+  }
+
+  inline std::shared_ptr<const image>
+  shared_follower::
+  open(std::uint64_t generation,
+       std::uint64_t schema,
+       std::uint64_t row_size,
+       std::size_t sections) const {
+
+    namespace bip = boost::interprocess;
+    try {
+      bip::shared_memory_object object(bip::open_only,
+                                       shared_generation(name_, generation).c_str(),
+                                       bip::read_only);
+      auto region = std::make_shared<bip::mapped_region>(object, bip::read_only);
+      return image::view(region->get_address(), region->get_size(),
+                         schema, row_size, sections, region);
+    }
+    catch (const bip::interprocess_exception&) {
+      return nullptr;
+    }
+  }
+
+}}
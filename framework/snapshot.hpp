@@ -0,0 +1,323 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// snapshot files, numbers in host byte order
+  ///
+  ///   header   magic, format, schema hash, row count  (4, 4, 8, 8 bytes)
+  ///   rows     fields in declaration order, numbers as they are, strings
+  ///            as a 32 bit length and their bytes without trailing NULs
+  ///   trailer  fnv-1a hash of the rows followed by the row count  (8 bytes)
+  ///
+  /// a file only loads into a mapping generated with the same schema
+  /// hash and read by the same format, the hash covers the generator
+  /// release as well as the fields
+  //////
+  constexpr std::uint32_t snapshot_magic  = 0x504e5352;
+  constexpr std::uint32_t snapshot_format = 2;
+
+  //////
+  /// fnv-1a, continues from hash so it can run over a file in pieces
+  //////
+  constexpr std::uint64_t fnv1a_basis = 0xcbf29ce484222325ull;
+
+  inline std::uint64_t
+  fnv1a(const char* data, std::size_t size, std::uint64_t hash = fnv1a_basis) {
+    for (std::size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  //////
+  /// restores a string saved without its padding to a padded column
+  //////
+  inline std::string
+  padded(std::string_view value, std::size_t size) {
+    std::string text(value);
+    if (text.size() < size) {
+      text.resize(size, '\0');
+    }
+    return text;
+  }
+
+  //////
+  /// class snapshot_writer
+  ///
+  /// streams rows into path.tmp and renames it over path on commit, a
+  /// writer destroyed without a successful commit leaves path untouched
+  //////
+  class snapshot_writer {
+  public:
+
+    snapshot_writer(const std::string& path, std::uint64_t schema);
+    ~snapshot_writer();
+
+    snapshot_writer(const snapshot_writer&) = delete;
+    snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+    //////
+    /// field writers
+    //////
+    template <typename T>
+    void write(T value);
+    void write_string(std::string_view value);
+
+    //////
+    /// completes the file with its row count and hash and publishes it
+    //////
+    bool commit(std::uint64_t rows);
+
+  private:
+
+    void flush();
+
+    //////
+    /// class members
+    //////
+    std::string    path_;
+    std::string    temp_;
+    std::ofstream  ofs_;
+    std::string    buffer_;
+    std::uint64_t  hash_;
+    bool           committed_;
+  };
+
+  //////
+  /// class snapshot_reader
+  ///
+  /// reads a whole file at once and checks its header and hash before
+  /// any row is read, a read past the end yields zeros and marks the
+  /// reader incomplete
+  //////
+  class snapshot_reader {
+  public:
+
+    snapshot_reader(const std::string& path, std::uint64_t schema);
+
+    //////
+    /// whether the file exists and matches format, schema and hash
+    //////
+    explicit operator bool() const;
+    std::uint64_t rows() const;
+
+    //////
+    /// field readers, a string view stays valid while the reader lives
+    //////
+    template <typename T>
+    T read();
+    std::string_view read_string();
+
+    //////
+    /// whether a read ran past the end, a row loop stops there
+    //////
+    bool overrun() const;
+
+    //////
+    /// whether every byte was read and no read ran past the end
+    //////
+    bool complete() const;
+
+  private:
+
+    const char* take(std::size_t size);
+
+    //////
+    /// class members
+    //////
+    std::vector<char>  data_;
+    std::size_t        pos_;
+    std::size_t        end_;
+    std::uint64_t      rows_;
+    bool               valid_;
+    bool               overrun_;
+  };
+
+  //////
+  /// snapshot_writer
+  //////
+
+  inline
+  snapshot_writer::
+  snapshot_writer(const std::string& path, std::uint64_t schema) :
+    path_(path),
+    temp_(path + ".tmp"),
+    ofs_(temp_, std::ios::binary | std::ios::trunc),
+    hash_(fnv1a_basis),
+    committed_(false) {
+
+    std::uint64_t rows = 0;
+    ofs_.write(reinterpret_cast<const char*>(&snapshot_magic), sizeof(snapshot_magic));
+    ofs_.write(reinterpret_cast<const char*>(&snapshot_format), sizeof(snapshot_format));
+    ofs_.write(reinterpret_cast<const char*>(&schema), sizeof(schema));
+    ofs_.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+  }
+
+  inline
+  snapshot_writer::
+  ~snapshot_writer() {
+    if (! committed_) {
+      ofs_.close();
+      std::remove(temp_.c_str());
+    }
+  }
+
+  template <typename T>
+  inline void
+  snapshot_writer::
+  write(T value) {
+
+    static_assert(std::is_arithmetic<T>::value, "snapshot fields are numbers or strings");
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    if (buffer_.size() >= 65536) {
+      flush();
+    }
+  }
+
+  inline void
+  snapshot_writer::
+  write_string(std::string_view value) {
+
+    std::size_t last = value.find_last_not_of('\0');
+    value = value.substr(0, last == std::string_view::npos ? 0 : last + 1);
+    write(static_cast<std::uint32_t>(value.size()));
+    buffer_.append(value.data(), value.size());
+  }
+
+  inline bool
+  snapshot_writer::
+  commit(std::uint64_t rows) {
+
+    flush();
+    hash_ = fnv1a(reinterpret_cast<const char*>(&rows), sizeof(rows), hash_);
+    ofs_.write(reinterpret_cast<const char*>(&hash_), sizeof(hash_));
+    ofs_.seekp(sizeof(snapshot_magic) + sizeof(snapshot_format) + sizeof(std::uint64_t));
+    ofs_.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    ofs_.close();
+    if (! ofs_ || std::rename(temp_.c_str(), path_.c_str()) != 0) {
+      return false;
+    }
+    committed_ = true;
+    return true;
+  }
+
+  inline void
+  snapshot_writer::
+  flush() {
+    hash_ = fnv1a(buffer_.data(), buffer_.size(), hash_);
+    ofs_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+  //////
+  /// snapshot_reader
+  //////
+
+  inline
+  snapshot_reader::
+  snapshot_reader(const std::string& path, std::uint64_t schema) :
+    pos_(0),
+    end_(0),
+    rows_(0),
+    valid_(false),
+    overrun_(false) {
+
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (! ifs) {
+      return;
+    }
+    data_.resize(static_cast<std::size_t>(ifs.tellg()));
+    ifs.seekg(0);
+    if (! ifs.read(data_.data(), data_.size())) {
+      return;
+    }
+    std::size_t header = 2 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t);
+    if (data_.size() < header + sizeof(std::uint64_t)) {
+      return;
+    }
+    end_ = data_.size() - sizeof(std::uint64_t);
+    std::uint32_t magic = read<std::uint32_t>();
+    std::uint32_t format = read<std::uint32_t>();
+    std::uint64_t hash = read<std::uint64_t>();
+    rows_ = read<std::uint64_t>();
+    std::uint64_t check;
+    std::memcpy(&check, data_.data() + end_, sizeof(check));
+    std::uint64_t sum = fnv1a(data_.data() + header, end_ - header);
+    sum = fnv1a(reinterpret_cast<const char*>(&rows_), sizeof(rows_), sum);
+    valid_ = magic == snapshot_magic && format == snapshot_format && hash == schema
+          && check == sum;
+  }
+
+  inline
+  snapshot_reader::
+  operator bool() const {
+    return valid_;
+  }
+
+  inline std::uint64_t
+  snapshot_reader::
+  rows() const {
+    return rows_;
+  }
+
+  template <typename T>
+  inline T
+  snapshot_reader::
+  read() {
+
+    static_assert(std::is_arithmetic<T>::value, "snapshot fields are numbers or strings");
+    T value = 0;
+    if (const char* p = take(sizeof(T))) {
+      std::memcpy(&value, p, sizeof(T));
+    }
+    return value;
+  }
+
+  inline std::string_view
+  snapshot_reader::
+  read_string() {
+
+    std::uint32_t size = read<std::uint32_t>();
+    const char* p = take(size);
+    return p ? std::string_view(p, size) : std::string_view();
+  }
+
+  inline bool
+  snapshot_reader::
+  overrun() const {
+    return overrun_;
+  }
+
+  inline bool
+  snapshot_reader::
+  complete() const {
+    return valid_ && ! overrun_ && pos_ == end_;
+  }
+
+  inline const char*
+  snapshot_reader::
+  take(std::size_t size) {
+
+    if (overrun_ || end_ - pos_ < size) {
+      overrun_ = true;
+      return nullptr;
+    }
+    const char* p = data_.data() + pos_;
+    pos_ += size;
+    return p;
+  }
+
+}}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// renders a value as a literal for an exec batch, integers as they are,
+  /// floating point in the shortest form that reads back to the same
+  /// value, strings up to their first NUL, quoted and with quotes doubled
+  //////
+  template <typename V>
+  std::string sql_literal(const V& value);
+
+  //////
+  /// sql_literal
+  //////
+  template <typename V>
+  inline std::string
+  sql_literal(const V& value) {
+
+    if constexpr (std::is_floating_point<V>::value) {
+      char text[64];
+      auto result = std::to_chars(text, text + sizeof(text), value);
+      return std::string(text, result.ptr);
+    }
+    else if constexpr (std::is_arithmetic<V>::value) {
+      return std::to_string(value);
+    }
+    else {
+      std::string_view text(value);
+      text = text.substr(0, text.find('\0'));
+      std::string literal = "'";
+      for (char c : text) {
+        literal += c;
+        if (c == '\'') {
+          literal += c;
+        }
+      }
+      return literal + "'";
+    }
+  }
+
+}}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// synthetic rows for the generated benchmarks, every value is a pure
+  /// function of its column and a key, so a benchmark can rebuild the
+  /// keys of the rows the synthetic connection returned
+  //////
+
+  //////
+  /// the key of row in a column of distinct values
+  //////
+  std::size_t synthetic_key(std::size_t row, std::size_t distinct);
+
+  //////
+  /// text for a column of the given width, the key in decimal padded on
+  /// the left from the column name to three quarters of the width and
+  /// never longer than width - 1, which leaves room for the terminator
+  //////
+  std::string synthetic_text(std::string_view column,
+                             std::size_t key,
+                             std::size_t width);
+
+  //////
+  /// text as a std::string member bound to the column holds it, the
+  /// full width with NULs after the value
+  //////
+  std::string synthetic_padded(const std::string& text, std::size_t width);
+
+  //////
+  /// a number for a numeric column
+  //////
+  template <typename T>
+  T synthetic_number(std::size_t key);
+
+  //////
+  /// the largest thread count the finder benchmarks run with
+  //////
+  int synthetic_threads();
+
+  //////
+  /// synthetic_key
+  //////
+  inline std::size_t
+  synthetic_key(std::size_t row, std::size_t distinct) {
+    return row % std::max<std::size_t>(distinct, 1);
+  }
+
+  //////
+  /// synthetic_text
+  //////
+  inline std::string
+  synthetic_text(std::string_view column,
+                 std::size_t key,
+                 std::size_t width) {
+
+    std::string digits = std::to_string(key);
+    std::size_t length = std::max(width * 3 / 4, digits.size());
+    length = std::min(length, width > 0 ? width - 1 : 0);
+    std::string text;
+    text.reserve(length);
+    for (std::size_t i = 0; text.size() + digits.size() < length; ++i) {
+      text += column.empty() ? 'x' : column[i % column.size()];
+    }
+    text += digits;
+    return text.substr(text.size() - std::min(text.size(), length));
+  }
+
+  //////
+  /// synthetic_padded
+  //////
+  inline std::string
+  synthetic_padded(const std::string& text, std::size_t width) {
+
+    std::string padded(width, '\0');
+    padded.replace(0, text.size(), text);
+    return padded;
+  }
+
+  //////
+  /// synthetic_number
+  //////
+  template <typename T>
+  inline T
+  synthetic_number(std::size_t key) {
+    return static_cast<T>(key);
+  }
+
+  //////
+  /// synthetic_threads
+  //////
+  inline int
+  synthetic_threads() {
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  }
+
+}}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <framework/mpsc_queue.hpp>
+#include <framework/sql.hpp>
+
+namespace rates {
+namespace framework {
+
+  //////
+  /// class write_behind
+  ///
+  /// queues rows for a writer thread that hands them to flush in groups,
+  /// a group closes at batch_size rows or once the queue stayed empty for
+  /// linger, it always holds whole pushes, flush sees it in slices of at
+  /// most batch_size rows, every future of a group receives the same
+  /// outcome once all of its slices were flushed, destruction flushes
+  /// what is queued and joins
+  //////
+  template <typename T>
+  class write_behind {
+  public:
+
+    using flush_function = std::function<bool(const T* rows, std::size_t count)>;
+
+    //////
+    /// constructor and destructor
+    //////
+    write_behind(std::size_t batch_size,
+                 std::chrono::steady_clock::duration linger,
+                 flush_function flush);
+    ~write_behind();
+
+    write_behind(const write_behind&) = delete;
+    write_behind& operator=(const write_behind&) = delete;
+
+    //////
+    /// queues one row or a batch, neither blocks on the writer thread
+    //////
+    std::future<bool> push(T row);
+    std::future<bool> push(std::vector<T> rows);
+
+  private:
+
+    //////
+    /// one push, a single row skips the vector
+    //////
+    struct entry {
+      T                   row;
+      std::vector<T>      rows;
+      bool                single = false;
+      std::promise<bool>  done;
+    };
+
+    //////
+    /// queues the entry and wakes the writer thread if it sleeps
+    //////
+    std::future<bool> enqueue(entry e);
+
+    //////
+    /// the writer thread
+    //////
+    void run();
+
+    //////
+    /// flushes one group and settles its futures
+    //////
+    void flush(std::vector<T>& rows, std::vector<std::promise<bool>>& done);
+
+    //////
+    /// class members, the thread last so it starts once all else is set
+    //////
+    std::size_t                          batch_size_;
+    std::chrono::steady_clock::duration  linger_;
+    flush_function                       flush_;
+    mpsc_queue<entry>                    queue_;
+    std::atomic<bool>                    idle_;
+    std::mutex                           lock_;
+    std::condition_variable              wake_;
+    bool                                 stopping_;
+    std::thread                          thread_;
+  };
+
+  //////
+  /// constructor
+  //////
+  template <typename T>
+  inline
+  write_behind<T>::
+  write_behind(std::size_t batch_size,
+               std::chrono::steady_clock::duration linger,
+               flush_function flush) :
+    batch_size_(batch_size ? batch_size : 1),
+    linger_(linger),
+    flush_(std::move(flush)),
+    idle_(false),
+    stopping_(false),
+    thread_(&write_behind::run, this) {
+  }
+
+  //////
+  /// destructor
+  //////
+  template <typename T>
+  inline
+  write_behind<T>::
+  ~write_behind() {
+    {
+      std::lock_guard<std::mutex>  guard(lock_);
+      stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+  }
+
+  //////
+  /// push
+  //////
+
+  template <typename T>
+  inline std::future<bool>
+  write_behind<T>::
+  push(T row) {
+
+    entry e;
+    e.row = std::move(row);
+    e.single = true;
+    return enqueue(std::move(e));
+  }
+
+  template <typename T>
+  inline std::future<bool>
+  write_behind<T>::
+  push(std::vector<T> rows) {
+
+    entry e;
+    e.rows = std::move(rows);
+    return enqueue(std::move(e));
+  }
+
+  //////
+  /// enqueue
+  //////
+  template <typename T>
+  inline std::future<bool>
+  write_behind<T>::
+  enqueue(entry e) {
+
+    std::future<bool> done = e.done.get_future();
+    queue_.push(std::move(e));
+    if (idle_.load()) {
+      std::lock_guard<std::mutex>  guard(lock_);
+      wake_.notify_one();
+    }
+    return done;
+  }
+
+  //////
+  /// run, the thread only announces it is idle once nothing is pending,
+  /// while it lingers producers push without waking it
+  //////
+  template <typename T>
+  inline void
+  write_behind<T>::
+  run() {
+
+    std::vector<T> rows;
+    std::vector<std::promise<bool>> done;
+    entry e;
+    bool lingered = false;
+    for (;;) {
+      if (queue_.pop(e)) {
+        if (e.single) {
+          rows.push_back(std::move(e.row));
+        }
+        else {
+          std::move(e.rows.begin(), e.rows.end(), std::back_inserter(rows));
+          e.rows.clear();
+        }
+        done.push_back(std::move(e.done));
+        if (rows.size() >= batch_size_) {
+          flush(rows, done);
+          lingered = false;
+        }
+        continue;
+      }
+      if (! done.empty()) {
+        std::unique_lock<std::mutex>  guard(lock_);
+        if (! lingered && ! stopping_) {
+          wake_.wait_for(guard, linger_, [this] { return stopping_; });
+          lingered = true;
+          continue;
+        }
+        guard.unlock();
+        flush(rows, done);
+        lingered = false;
+        continue;
+      }
+      std::unique_lock<std::mutex>  guard(lock_);
+      idle_.store(true);
+      wake_.wait(guard, [this] { return stopping_ || ! queue_.empty(); });
+      idle_.store(false);
+      if (stopping_ && queue_.empty()) {
+        return;
+      }
+    }
+  }
+
+  //////
+  /// flush
+  //////
+  template <typename T>
+  inline void
+  write_behind<T>::
+  flush(std::vector<T>& rows, std::vector<std::promise<bool>>& done) {
+
+    bool ok = true;
+    for (std::size_t i = 0; i < rows.size(); i += batch_size_) {
+      std::size_t count = std::min(batch_size_, rows.size() - i);
+      try {
+        ok = flush_(rows.data() + i, count) && ok;
+      }
+      catch (...) {
+        ok = false;
+      }
+    }
+    for (auto& d : done) {
+      d.set_value(ok);
+    }
+    rows.clear();
+    done.clear();
+  }
+
+}}
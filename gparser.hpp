@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <vector>
 #include <set>
 #include <map>
@@ -13,6 +17,13 @@
 namespace rates {
 namespace framework {
 
+  //////
+  /// release of the generator, mixed into the schema hash so snapshot
+  /// files and images written by code of an earlier release are refused,
+  /// bump it with every release, whatever it changes
+  //////
+  constexpr unsigned generator_version = 1;
+
   class index {
   public:
 
@@ -23,6 +34,7 @@ namespace framework {
     const std::string& type() const;
     const std::string& alias() const;
     const index_pairs& get_index_pairs() const;
+    bool is_flat() const;
 
     void type(const std::string&);
     void alias(const std::string&);
@@ -54,6 +66,12 @@ namespace framework {
     return index_pairs_;
   }
 
+  inline bool
+  index::
+  is_flat() const {
+    return type_ == "sorted-vector" || type_ == "eytzinger";
+  }
+
   inline void
   index::
   type(const std::string& typ) {
@@ -81,12 +99,14 @@ namespace framework {
     const std::string& ref_name() const;
     size_t size() const;
     const std::string& db_name() const;
+    const std::string& encoding() const;
 
     void name(const std::string&);
     void type(const std::string&);
     void ref_name(const std::string&);
     void size(size_t sz);
     void db_name(const std::string&);
+    void encoding(const std::string&);
     using ptr = std::shared_ptr<field>;
 
   private:
@@ -96,6 +116,7 @@ namespace framework {
     std::string  type_;
     std::string  ref_name_;
     std::string  db_name_;
+    std::string  encoding_;
   };
   using fields = std::vector<field::ptr>;
 
@@ -129,6 +150,12 @@ namespace framework {
     return db_name_;
   }
 
+  inline const std::string&
+  field::
+  encoding() const {
+    return encoding_;
+  }
+
   inline void
   field::
   name(const std::string& name) {
@@ -159,6 +186,12 @@ namespace framework {
     db_name_ = name;
   }
 
+  inline void
+  field::
+  encoding(const std::string& enc) {
+    encoding_ = enc;
+  }
+
   class stored_proc {
   public:
 
@@ -224,36 +257,379 @@ namespace framework {
 
     using ptr = std::shared_ptr<component>;
 
+    component();
+
     const std::string& class_name() const;
+    const std::string& concurrency() const;
+    size_t shards() const;
+    size_t expected_rows() const;
+    const std::string& storage() const;
+    const std::string& layout() const;
+    const std::string& allocation() const;
+    const std::string& load_mode() const;
+    const std::string& compilation() const;
+    bool raw_finders() const;
+    bool batch_finders() const;
+    bool shared_memory() const;
+    bool benchmark() const;
+    const std::string& version() const;
+    const std::string& deleted() const;
+    index::ptr unique_index() const;
+    bool has_flat_indices() const;
+    bool has_refresh() const;
+    bool has_writer() const;
+    bool has_bulk_load() const;
+    unsigned long long schema_hash() const;
+    unsigned long long image_hash() const;
+    stored_proc::parameter partition_parameter() const;
+    field::ptr get_field(const std::string& name) const;
+    bool is_fixed(field::ptr fld) const;
+    bool is_encoded(field::ptr fld) const;
+    bool has_encoded() const;
+    bool has_fetch_buffers() const;
+    bool is_trivially_copyable() const;
+    std::string member_type(field::ptr fld) const;
+    std::string value_type(field::ptr fld) const;
     const fields& get_fields() const;
     const indices& get_indices() const;
     const stored_procs& get_stored_procs() const;
 
     void class_name(const std::string& name);
+    void concurrency(const std::string& mode);
+    void shards(size_t count);
+    void expected_rows(size_t count);
+    void storage(const std::string& mode);
+    void layout(const std::string& mode);
+    void allocation(const std::string& mode);
+    void load_mode(const std::string& mode);
+    void compilation(const std::string& mode);
+    void raw_finders(bool enabled);
+    void batch_finders(bool enabled);
+    void shared_memory(bool enabled);
+    void benchmark(bool enabled);
+    void version(const std::string& name);
+    void deleted(const std::string& name);
     void push_back(field::ptr);
     void push_back(index::ptr);
     void insert(stored_proc::ptr);
+
+    //////
+    /// builds the header in memory and writes it only when it differs
+    /// from the one on disk, so an unchanged header keeps its mtime,
+    /// messages go to log so components can generate side by side
+    ///
+    /// split compilation also builds a .cpp, the header then declares the
+    /// mapping and its table type extern and the .cpp instantiates both,
+    /// a benchmarked component also gets a <class>_bench.cpp
+    //////
     void generate();
+    std::string log() const;
+    bool written() const;
+    static bool write_if_changed(const std::string& path, const std::string& text);
 
   private:
 
     void declare_prologue();
-
-    bool           needs_mapping_;
-    std::string    class_name_;
-    fields         fields_;
-    indices        indices_;
-    stored_procs   stored_procs_;
-    std::ofstream  ofs_;
+    void declare_source_prologue();
+    static std::string without_inline(const std::string& text);
+    static unsigned long long hash(const std::string& text);
+
+    bool                needs_mapping_;
+    std::string         class_name_;
+    std::string         concurrency_;
+    size_t              shards_;
+    size_t              expected_rows_;
+    std::string         storage_;
+    std::string         layout_;
+    std::string         allocation_;
+    std::string         load_mode_;
+    std::string         compilation_;
+    bool                raw_finders_;
+    bool                batch_finders_;
+    bool                shared_memory_;
+    bool                benchmark_;
+    std::string         version_;
+    std::string         deleted_;
+    fields              fields_;
+    indices             indices_;
+    stored_procs        stored_procs_;
+    std::ostringstream  ofs_;
+    std::ostringstream  src_;
+    std::ostringstream  bench_;
+    std::ostringstream  log_;
+    bool                written_;
   };
   using components = std::vector<component::ptr>;
 
+  inline
+  component::
+  component() :
+    needs_mapping_(true),
+    concurrency_("mutex"),
+    shards_(16),
+    expected_rows_(0),
+    storage_("string"),
+    layout_("rows"),
+    allocation_("shared"),
+    load_mode_("serial"),
+    compilation_("header"),
+    raw_finders_(false),
+    batch_finders_(false),
+    shared_memory_(false),
+    benchmark_(false),
+    written_(false) {
+  }
+
   inline const std::string&
   component::
   class_name() const {
     return class_name_;
   }
 
+  inline const std::string&
+  component::
+  concurrency() const {
+    return concurrency_;
+  }
+
+  inline size_t
+  component::
+  shards() const {
+    return shards_;
+  }
+
+  inline size_t
+  component::
+  expected_rows() const {
+    return expected_rows_;
+  }
+
+  inline const std::string&
+  component::
+  storage() const {
+    return storage_;
+  }
+
+  inline const std::string&
+  component::
+  layout() const {
+    return layout_;
+  }
+
+  inline const std::string&
+  component::
+  allocation() const {
+    return allocation_;
+  }
+
+  inline const std::string&
+  component::
+  load_mode() const {
+    return load_mode_;
+  }
+
+  inline const std::string&
+  component::
+  compilation() const {
+    return compilation_;
+  }
+
+  inline bool
+  component::
+  raw_finders() const {
+    return raw_finders_;
+  }
+
+  inline bool
+  component::
+  batch_finders() const {
+    return batch_finders_;
+  }
+
+  inline bool
+  component::
+  shared_memory() const {
+    return shared_memory_;
+  }
+
+  inline bool
+  component::
+  benchmark() const {
+    return benchmark_;
+  }
+
+  inline const std::string&
+  component::
+  version() const {
+    return version_;
+  }
+
+  inline const std::string&
+  component::
+  deleted() const {
+    return deleted_;
+  }
+
+  inline index::ptr
+  component::
+  unique_index() const {
+    for (auto ndx : indices_) {
+      if (ndx->type() == "ordered-unique" || ndx->type() == "hashed-unique") {
+        return ndx;
+      }
+    }
+    return index::ptr();
+  }
+
+  inline bool
+  component::
+  has_flat_indices() const {
+    for (auto ndx : indices_) {
+      if (ndx->is_flat()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline bool
+  component::
+  has_refresh() const {
+    return stored_procs_.find("fingerprint") != stored_procs_.end();
+  }
+
+  inline bool
+  component::
+  has_writer() const {
+    return stored_procs_.find("insert") != stored_procs_.end();
+  }
+
+  inline bool
+  component::
+  has_bulk_load() const {
+    return layout_ == "rows" && ! has_flat_indices();
+  }
+
+  inline unsigned long long
+  component::
+  schema_hash() const {
+    std::string schema = std::to_string(generator_version) + "|" + class_name_;
+    for (auto fld : fields_) {
+      schema += "|" + fld->name() + ":" + fld->type() + ":" + std::to_string(fld->size());
+    }
+    return hash(schema);
+  }
+
+  inline unsigned long long
+  component::
+  image_hash() const {
+    std::string schema = std::to_string(schema_hash());
+    for (auto ndx : indices_) {
+      schema += "|" + ndx->alias() + ":" + ndx->type();
+      for (const auto& key : ndx->get_index_pairs()) {
+        schema += ":" + key.first;
+      }
+    }
+    return hash(schema);
+  }
+
+  inline unsigned long long
+  component::
+  hash(const std::string& text) {
+    unsigned long long hash = 0xcbf29ce484222325ull;
+    for (char c : text) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  inline stored_proc::parameter
+  component::
+  partition_parameter() const {
+    auto i = stored_procs_.find("read");
+    if (i == stored_procs_.end() || i->second->get_parameters().size() != 1) {
+      return stored_proc::parameter();
+    }
+    return i->second->get_parameters().front();
+  }
+
+  inline field::ptr
+  component::
+  get_field(const std::string& name) const {
+    for (auto fld : fields_) {
+      if (fld->name() == name) {
+        return fld;
+      }
+    }
+    return field::ptr();
+  }
+
+  inline bool
+  component::
+  is_fixed(field::ptr fld) const {
+    return storage_ == "inline" && fld->type() == "std::string" && fld->size() > 0 &&
+           ! is_encoded(fld);
+  }
+
+  inline bool
+  component::
+  is_encoded(field::ptr fld) const {
+    return fld->encoding() == "dictionary";
+  }
+
+  inline bool
+  component::
+  has_encoded() const {
+    for (auto fld : fields_) {
+      if (is_encoded(fld)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline bool
+  component::
+  has_fetch_buffers() const {
+    return storage_ == "inline" || has_encoded();
+  }
+
+  inline bool
+  component::
+  is_trivially_copyable() const {
+    for (auto fld : fields_) {
+      if (fld->type() == "std::string" && ! is_fixed(fld) && ! is_encoded(fld)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline std::string
+  component::
+  member_type(field::ptr fld) const {
+    if (is_encoded(fld)) {
+      return "std::uint32_t";
+    }
+    if (is_fixed(fld)) {
+      return "framework::fixed_string<" + std::to_string(fld->size()) + ">";
+    }
+    return fld->type();
+  }
+
+  inline std::string
+  component::
+  value_type(field::ptr fld) const {
+    if (is_fixed(fld) || is_encoded(fld)) {
+      return "std::string_view";
+    }
+    if (fld->type() == "std::string") {
+      return "const std::string&";
+    }
+    return fld->type();
+  }
+
   inline const fields&
   component::
   get_fields() const {
@@ -278,6 +654,125 @@ namespace framework {
     class_name_ = name;
   }
 
+  inline void
+  component::
+  concurrency(const std::string& mode) {
+    if (mode != "mutex" && mode != "snapshot" && mode != "sharded") {
+      log_ << "unknown concurrency " << mode
+           << " for " << class_name_ << ", using mutex" << std::endl;
+      concurrency_ = "mutex";
+      return;
+    }
+    concurrency_ = mode;
+  }
+
+  inline void
+  component::
+  shards(size_t count) {
+    shards_ = count > 0 ? count : 1;
+  }
+
+  inline void
+  component::
+  expected_rows(size_t count) {
+    expected_rows_ = count;
+  }
+
+  inline void
+  component::
+  storage(const std::string& mode) {
+    if (mode != "string" && mode != "inline") {
+      log_ << "unknown storage " << mode
+           << " for " << class_name_ << ", using string" << std::endl;
+      storage_ = "string";
+      return;
+    }
+    storage_ = mode;
+  }
+
+  inline void
+  component::
+  layout(const std::string& mode) {
+    if (mode != "rows" && mode != "columnar" && mode != "mapped") {
+      log_ << "unknown layout " << mode
+           << " for " << class_name_ << ", using rows" << std::endl;
+      layout_ = "rows";
+      return;
+    }
+    layout_ = mode;
+  }
+
+  inline void
+  component::
+  allocation(const std::string& mode) {
+    if (mode != "shared" && mode != "arena") {
+      log_ << "unknown allocation " << mode
+           << " for " << class_name_ << ", using shared" << std::endl;
+      allocation_ = "shared";
+      return;
+    }
+    allocation_ = mode;
+  }
+
+  inline void
+  component::
+  load_mode(const std::string& mode) {
+    if (mode != "serial" && mode != "pipelined") {
+      log_ << "unknown load " << mode << ", using serial" << std::endl;
+      load_mode_ = "serial";
+      return;
+    }
+    load_mode_ = mode;
+  }
+
+  inline void
+  component::
+  compilation(const std::string& mode) {
+    if (mode != "header" && mode != "split") {
+      log_ << "unknown compilation " << mode
+           << " for " << class_name_ << ", using header" << std::endl;
+      compilation_ = "header";
+      return;
+    }
+    compilation_ = mode;
+  }
+
+  inline void
+  component::
+  raw_finders(bool enabled) {
+    raw_finders_ = enabled;
+  }
+
+  inline void
+  component::
+  batch_finders(bool enabled) {
+    batch_finders_ = enabled;
+  }
+
+  inline void
+  component::
+  shared_memory(bool enabled) {
+    shared_memory_ = enabled;
+  }
+
+  inline void
+  component::
+  benchmark(bool enabled) {
+    benchmark_ = enabled;
+  }
+
+  inline void
+  component::
+  version(const std::string& name) {
+    version_ = name;
+  }
+
+  inline void
+  component::
+  deleted(const std::string& name) {
+    deleted_ = name;
+  }
+
   inline void
   component::
   push_back(field::ptr fld) {
@@ -300,47 +795,123 @@ namespace framework {
   public:
 
     void parse(const std::string& fname);
+
+    //////
+    /// parses the files side by side, each one streamed in chunks into
+    /// its own json parser, then merges their components in the order
+    /// given, a class already defined by an earlier file is skipped
+    //////
+    void parse_many(const std::vector<std::string>& fnames);
+
+    //////
+    /// parse_many over the .json files of dir, in name order
+    //////
+    void parse_directory(const std::string& dir);
     void generate();
 
   private:
 
+    components parse_file(const std::string& fname, std::ostream& log);
+    void merge(const std::string& fname, const components& comps);
+
+    template <typename Work>
+    static void run_parallel(std::size_t count, Work work);
+    void generate_bench_makefile();
+
     void parse_fields(component::ptr comp,
-                      const boost::json::value& val);
+                      const boost::json::value& val,
+                      std::ostream& log);
 
     field::ptr parse_field(const boost::json::value& val);
 
     void parse_indices(component::ptr comp,
-                       const boost::json::value& val);
+                       const boost::json::value& val,
+                       std::ostream& log);
 
     index::ptr parse_index(const boost::json::value& val);
 
     void parse_stored_procs(component::ptr comp,
-                            const boost::json::value& val);
+                            const boost::json::value& val,
+                            std::ostream& log);
     stored_proc::ptr parse_stored_proc(const boost::json::value& val);
 
-    components components_;
+    components                          components_;
+    std::map<std::string, std::string>  defined_in_;
   };
 
   inline void
   parser::
   parse(const std::string& fname) {
-  
-    std::ifstream ifs(fname);
-    std::stringstream ss;
-    ss << ifs.rdbuf();
 
-    boost::json::stream_parser par;
-    boost::json::error_code ec;
-    const std::string s = ss.str();
-    par.write(s.c_str(), s.size(), ec);
+    std::ostringstream log;
+    components comps = parse_file(fname, log);
+    std::cout << log.str();
+    merge(fname, comps);
+  }
+
+  inline void
+  parser::
+  parse_many(const std::vector<std::string>& fnames) {
+
+    std::vector<components> parsed(fnames.size());
+    std::vector<std::ostringstream> logs(fnames.size());
+    run_parallel(fnames.size(), [&](std::size_t i) {
+      parsed[i] = parse_file(fnames[i], logs[i]);
+    });
+    for (std::size_t i = 0; i < fnames.size(); ++i) {
+      std::cout << logs[i].str();
+      merge(fnames[i], parsed[i]);
+    }
+  }
+
+  inline void
+  parser::
+  parse_directory(const std::string& dir) {
+
+    std::vector<std::string> fnames;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator i(dir, ec), j; ! ec && i != j; i.increment(ec)) {
+      if (i->is_regular_file() && i->path().extension() == ".json") {
+        fnames.push_back(i->path().string());
+      }
+    }
     if (ec) {
-      std::cout << "parsing failed: " << ec << std::endl;
+      std::cout << "cannot read " << dir << ": " << ec.message() << std::endl;
       return;
     }
+    std::sort(fnames.begin(), fnames.end());
+    parse_many(fnames);
+  }
+
+  //////
+  /// the file is fed to the json parser a chunk at a time, it is never
+  /// held whole in memory besides the parsed value
+  //////
+  inline components
+  parser::
+  parse_file(const std::string& fname, std::ostream& log) {
+
+    components comps;
+    std::ifstream ifs(fname, std::ios::binary);
+    if (! ifs) {
+      log << "cannot open " << fname << std::endl;
+      return comps;
+    }
+
+    boost::json::stream_parser par;
+    boost::json::error_code ec;
+    std::vector<char> chunk(64 * 1024);
+    while (ifs.read(chunk.data(), chunk.size()) || ifs.gcount() > 0) {
+      par.write(chunk.data(), ifs.gcount(), ec);
+      if (ec) {
+        log << fname << " parsing failed: " << ec << std::endl;
+        return comps;
+      }
+    }
     par.finish(ec);
     if (ec) {
-      std::cout << "finish failed: " << ec << std::endl;
-      return;
+      log << fname << " finish failed: " << ec << std::endl;
+      return comps;
     }
     auto node = par.release();
     auto top = node.get_object();
@@ -357,31 +928,172 @@ namespace framework {
       for (; p != q; ++p) {
         std::string key = p->key();
         if (key == "fields") {
-          parse_fields(comp, p->value());
+          parse_fields(comp, p->value(), log);
         }
         else if (key == "indices") {
-          parse_indices(comp, p->value());
+          parse_indices(comp, p->value(), log);
         }
         else if (key == "stored_procs") {
-          parse_stored_procs(comp, p->value());
+          parse_stored_procs(comp, p->value(), log);
+        }
+        else if (key == "concurrency") {
+          comp->concurrency(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "layout") {
+          comp->layout(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "batch_finders") {
+          comp->batch_finders(boost::json::value_to<std::string>(p->value()) == "true");
+        }
+        else if (key == "raw_finders") {
+          comp->raw_finders(boost::json::value_to<std::string>(p->value()) == "true");
+        }
+        else if (key == "shared_memory") {
+          comp->shared_memory(boost::json::value_to<std::string>(p->value()) == "true");
+        }
+        else if (key == "benchmark") {
+          comp->benchmark(boost::json::value_to<std::string>(p->value()) == "true");
+        }
+        else if (key == "version") {
+          comp->version(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "deleted") {
+          comp->deleted(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "load") {
+          comp->load_mode(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "compilation") {
+          comp->compilation(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "allocation") {
+          comp->allocation(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "storage") {
+          comp->storage(boost::json::value_to<std::string>(p->value()));
+        }
+        else if (key == "shards") {
+          std::string val = boost::json::value_to<std::string>(p->value());
+          comp->shards(::atoi(val.c_str()));
+        }
+        else if (key == "expected_rows") {
+          std::string val = boost::json::value_to<std::string>(p->value());
+          comp->expected_rows(::atoi(val.c_str()));
         }
       }
-      components_.push_back(comp);
+      comps.push_back(comp);
     }
+    return comps;
   }
 
   inline void
   parser::
-  generate() {
-    for (auto comp : components_) {
-      comp->generate();
+  merge(const std::string& fname, const components& comps) {
+
+    for (auto comp : comps) {
+      auto found = defined_in_.find(comp->class_name());
+      if (found != defined_in_.end()) {
+        std::cout << "duplicate class " << comp->class_name() << " in " << fname
+                  << ", first defined in " << found->second << ", skipping" << std::endl;
+        continue;
+      }
+      defined_in_[comp->class_name()] = fname;
+      components_.push_back(comp);
+    }
+  }
+
+  template <typename Work>
+  inline void
+  parser::
+  run_parallel(std::size_t count, Work work) {
+
+    std::atomic<std::size_t> next(0);
+    auto run = [&work, &next, count] {
+      for (std::size_t i = next++; i < count; i = next++) {
+        work(i);
+      }
+    };
+    std::size_t threads = std::min<std::size_t>(
+      std::max(1u, std::thread::hardware_concurrency()), count);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i) {
+      workers.emplace_back(run);
+    }
+    run();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  inline void
+  parser::
+  generate() {
+
+    run_parallel(components_.size(), [this](std::size_t i) {
+      components_[i]->generate();
+    });
+
+    std::size_t written = 0;
+    for (auto comp : components_) {
+      std::cout << comp->log();
+      written += comp->written();
+    }
+    std::cout << written << " of " << components_.size() << " headers written, "
+              << components_.size() - written << " unchanged" << std::endl;
+    generate_bench_makefile();
+  }
+
+  //////
+  /// one make target per benchmarked component and a bench target that
+  /// builds and runs them all, framework/bench goes first on the include
+  /// path so the synthetic connection stands in for db/connection.hpp
+  //////
+  inline void
+  parser::
+  generate_bench_makefile() {
+
+    std::ostringstream mk;
+    std::string targets;
+    std::ostringstream rules;
+    for (auto comp : components_) {
+      if (! comp->benchmark()) {
+        continue;
+      }
+      std::string name = comp->class_name();
+      std::string sources = name + "_bench.cpp";
+      if (comp->compilation() == "split") {
+        sources += " " + name + ".cpp";
+      }
+      targets += " " + name + "_bench";
+      rules << name << "_bench: " << sources << " " << name << ".hpp" << std::endl
+            << "\t$(CXX) $(CXXFLAGS) $(BENCH_INCLUDES) -o $@ " << sources
+            << " $(BENCH_LIBS)" << std::endl << std::endl;
     }
+    if (targets.empty()) {
+      return;
+    }
+    mk << "#" << std::endl
+       << "# generated benchmarks, make -f bench.mk bench builds and runs them," << std::endl
+       << "# ROOT is where framework/ lives and BENCH_ARGS go to every run" << std::endl
+       << "#" << std::endl
+       << "CXXFLAGS       ?= -std=c++17 -O2" << std::endl
+       << "ROOT           ?= ." << std::endl
+       << "BENCH_INCLUDES  = -I$(ROOT)/framework/bench -I$(ROOT) -I." << std::endl
+       << "BENCH_LIBS      = -lbenchmark -lpthread" << std::endl
+       << "BENCHMARKS      =" << targets << std::endl << std::endl
+       << "bench: $(BENCHMARKS)" << std::endl
+       << "\tfor b in $(BENCHMARKS); do ./$$b $(BENCH_ARGS) || exit 1; done" << std::endl
+       << std::endl
+       << rules.str()
+       << ".PHONY: bench" << std::endl;
+    component::write_if_changed("./bench.mk", mk.str());
   }
 
   inline void
   parser::
   parse_fields(component::ptr comp,
-               const boost::json::value& val) {
+               const boost::json::value& val,
+               std::ostream& log) {
 
     auto node = val.get_array();
     auto p = node.begin();
@@ -390,12 +1102,12 @@ namespace framework {
     for (; p != q; ++p) {
       field::ptr fld = parse_field(*p);
       if (! fld) {
-        std::cout << "Failed to make field" << std::endl;
+        log << "Failed to make field" << std::endl;
         return;
       }
       comp->push_back(fld);
     }
-    std::cout << comp->get_fields().size() << std::endl;
+    log << comp->get_fields().size() << std::endl;
     return;
   }
 
@@ -428,6 +1140,9 @@ namespace framework {
       else if (key == "db_name") {
         fld->db_name(val);
       }
+      else if (key == "encoding") {
+        fld->encoding(val);
+      }
     }
     return fld;
   }
@@ -435,7 +1150,8 @@ namespace framework {
   inline void
   parser::
   parse_indices(component::ptr comp,
-                const boost::json::value& val) {
+                const boost::json::value& val,
+                std::ostream& log) {
 
     auto node = val.get_array();
     auto p = node.begin();
@@ -444,12 +1160,12 @@ namespace framework {
     for (; p != q; ++p) {
       index::ptr ndx = parse_index(*p);
       if (! ndx) {
-        std::cout << "Failed to make index" << std::endl;
+        log << "Failed to make index" << std::endl;
         return;
       }
       comp->push_back(ndx);
     }
-    std::cout << comp->get_indices().size() << std::endl;
+    log << comp->get_indices().size() << std::endl;
   }
 
   inline index::ptr
@@ -488,7 +1204,8 @@ namespace framework {
   inline void
   parser::
   parse_stored_procs(component::ptr comp,
-                     const boost::json::value& val) {
+                     const boost::json::value& val,
+                     std::ostream& log) {
 
     auto node = val.get_array();
     auto p = node.begin();
@@ -496,7 +1213,7 @@ namespace framework {
     for (; p != q; ++p) {
       stored_proc::ptr sp = parse_stored_proc(*p);
       if (! sp) {
-        std::cout << "Failed to make sp" << std::endl;
+        log << "Failed to make sp" << std::endl;
         return;
       }
       comp->insert(sp);
@@ -540,7 +1257,7 @@ namespace framework {
   class instance_maker {
   public:
 
-    instance_maker(std::ofstream& ofs, component::ptr comp);
+    instance_maker(std::ostream& ofs, component::ptr comp);
     void make();
 
   private:
@@ -556,28 +1273,154 @@ namespace framework {
     void implement_mutators();
     void implement_bind();
 
-    std::ofstream&  ofs_;
+    std::ostream&   ofs_;
+    component::ptr  component_;
+  };
+
+  class columns_maker {
+  public:
+
+    columns_maker(std::ostream& ofs, component::ptr comp);
+    void make();
+
+  private:
+
+    void declare_columns();
+    void declare_view();
+    void implement_columns();
+    void implement_view();
+
+    std::ostream&   ofs_;
     component::ptr  component_;
   };
 
   class mapping_maker {
   public:
 
-    mapping_maker(std::ofstream& ofs, component::ptr comp);
+    mapping_maker(std::ostream& ofs, component::ptr comp);
     void make();
+    void declare();
+    void implement();
+    void declare_table_instantiation();
+    void implement_table_instantiation();
 
   private:
 
     void declare_class();
     void declare_singleton_accessor();
     void declare_load();
+    void declare_writers();
     void declare_finders();
     void declare_members();
+    void declare_key_parameters(const std::string& lead,
+                                index::ptr ndx,
+                                const std::string& close);
+    void declare_flat_table(const indices& nodes);
+    void declare_table_members();
+    void declare_generation();
+    void declare_delta_members();
+    void declare_bulk_members();
+    void declare_snapshot_members();
+    void declare_pipeline_members();
+    void declare_partition_members();
+    void declare_writer_members();
+    void declare_refresh_members();
+    void declare_range_finders();
+    void declare_class_end();
+    bool has_table_instantiation();
+    std::string table_instantiation();
+    indices node_indices();
+    bool has_range(index::ptr ndx);
+    void declare_raw_current();
+    void declare_columnar_members();
+    void declare_mapped_members();
+    void implement_constructor();
     void implement_singleton_accessor();
+    void implement_flat_table();
+    void implement_columnar_table();
+    void implement_mapped_table();
+    void implement_image();
+    void implement_shard_of();
     void implement_load();
+    void implement_load_stats();
+    void implement_snapshot();
+    void implement_snapshot_write(const std::string& indent,
+                                  const std::string& prefix,
+                                  const std::string& suffix);
+    void implement_snapshot_read(const std::string& indent);
+    void implement_load_partitioned();
+    void implement_build(const std::string& rows);
+    void implement_build_end(const std::string& rows);
+    void implement_delta();
+    void implement_refresh();
+    void implement_write_behind();
+    void implement_mark_store();
+    void implement_writers();
     void implement_finders();
 
-    std::ofstream&  ofs_;
+    std::string key_arguments(index::ptr ndx,
+                              const std::string& prefix,
+                              const std::string& suffix,
+                              const std::string& separator);
+    std::string key_lookup(index::ptr ndx);
+    std::string key_type(const index::index_pair& key);
+    std::string key_member(const index::index_pair& key);
+    std::string key_code(const index::index_pair& key, const std::string& arg);
+    std::string key_tuple(index::ptr ndx);
+    std::string element_type();
+    std::string element_parameter();
+    std::string hold(const std::string& row);
+    std::string result_type();
+    void implement_fetch_loop(const std::string& insert, const std::string& rows);
+    void implement_generation();
+    void implement_raw_finders();
+    void implement_batch_finders();
+    void implement_range_finders();
+    void implement_table_access();
+    std::string batch_key_type(index::ptr ndx);
+    std::string batch_arguments(index::ptr ndx, const std::string& key);
+    std::string batch_lookup(index::ptr ndx, const std::string& key);
+    void implement_raw_publish(const std::string& owner);
+    void implement_flat_lookup(index::ptr ndx,
+                               const std::string& found,
+                               const std::string& none);
+    std::string current_type();
+
+    std::ostream&   ofs_;
+    component::ptr  component_;
+  };
+
+  //////
+  /// class bench_maker
+  ///
+  /// a google benchmark source per component, load throughput and
+  /// allocations per row against the synthetic connection of
+  /// framework/bench, the time to drop a loaded table and the single key
+  /// and batch finders of every index, single key finders at 1..N threads
+  //////
+  class bench_maker {
+  public:
+
+    bench_maker(std::ostream& ofs, component::ptr comp);
+    void make();
+
+  private:
+
+    void declare_prologue();
+    void declare_connection();
+    void declare_keys();
+    void declare_load();
+    void declare_finder(index::ptr ndx);
+    void declare_batch_finder(index::ptr ndx);
+    void declare_epilogue();
+    fields key_fields();
+    fields columns();
+    bool is_unique_column(const std::string& db_name);
+    std::string column_width(field::ptr fld);
+    std::string key_value(field::ptr fld, const std::string& row);
+    std::string finder_arguments(index::ptr ndx, const std::string& at);
+
+    std::ostream&   ofs_;
     component::ptr  component_;
   };
 
@@ -585,37 +1428,335 @@ namespace framework {
   component::
   generate() {
 
+    if (concurrency_ == "sharded" && ! unique_index()) {
+      log_ << class_name_ << " has no unique index to shard by, "
+           << "using mutex" << std::endl;
+      concurrency_ = "mutex";
+    }
+    if (concurrency_ == "sharded") {
+      size_t unique = 0;
+      for (auto ndx : indices_) {
+        if (ndx->type() == "ordered-unique" || ndx->type() == "hashed-unique") {
+          ++unique;
+        }
+      }
+      if (unique > 1) {
+        log_ << class_name_ << " is sharded by " << unique_index()->alias()
+             << " and its other unique indices would only be unique per shard, "
+             << "using mutex" << std::endl;
+        concurrency_ = "mutex";
+      }
+    }
+    for (auto fld : fields_) {
+      if (fld->encoding().empty()) {
+        continue;
+      }
+      if (fld->encoding() != "dictionary") {
+        log_ << "unknown encoding " << fld->encoding() << " for "
+             << class_name_ << "::" << fld->name() << ", not encoding it" << std::endl;
+        fld->encoding("");
+      }
+      else if (fld->type() != "std::string" || fld->size() == 0 || layout_ != "rows") {
+        log_ << class_name_ << "::" << fld->name() << " dictionary encoding needs "
+             << "a sized string and the rows layout, not encoding it" << std::endl;
+        fld->encoding("");
+      }
+    }
+    if (layout_ == "mapped" && (storage_ != "inline" || ! is_trivially_copyable())) {
+      log_ << class_name_ << " mapped rows need inline storage and sized "
+           << "strings, using rows" << std::endl;
+      layout_ = "rows";
+    }
+    if (shared_memory_ && layout_ != "mapped") {
+      log_ << class_name_ << " shares its table through the mapped layout, "
+           << "not generating shared memory" << std::endl;
+      shared_memory_ = false;
+    }
+    if (concurrency_ == "sharded" && layout_ != "rows") {
+      log_ << class_name_ << " is " << layout_ << " and cannot be sharded, "
+           << "using mutex" << std::endl;
+      concurrency_ = "mutex";
+    }
+    if (concurrency_ == "sharded") {
+      for (auto ndx : indices_) {
+        if (ndx->is_flat()) {
+          log_ << class_name_ << " is sharded, index " << ndx->alias()
+               << " becomes ordered-non-unique" << std::endl;
+          ndx->type("ordered-non-unique");
+        }
+      }
+    }
+
+    if (allocation_ == "arena" && concurrency_ == "sharded") {
+      log_ << class_name_ << " is sharded and cannot use an arena, "
+           << "using shared" << std::endl;
+      allocation_ = "shared";
+    }
+    if (allocation_ == "arena" && layout_ != "rows") {
+      log_ << class_name_ << " is " << layout_ << " and needs no arena, "
+           << "using shared" << std::endl;
+      allocation_ = "shared";
+    }
+    if (raw_finders_ && (concurrency_ != "snapshot" || layout_ != "rows")) {
+      log_ << class_name_ << " raw finders need snapshot concurrency "
+           << "and the rows layout, not generating them" << std::endl;
+      raw_finders_ = false;
+    }
+    if (! version_.empty()) {
+      field::ptr ver = get_field(version_);
+      field::ptr del = get_field(deleted_);
+      if (stored_procs_.find("delta") == stored_procs_.end()) {
+        log_ << class_name_ << " has no delta stored proc, "
+             << "not generating apply_delta" << std::endl;
+        version_.clear();
+      }
+      else if (! ver || ver->type() == "std::string" ||
+               (! deleted_.empty() && (! del || del->type() == "std::string"))) {
+        log_ << class_name_ << " delta version and deleted must name numeric "
+             << "fields, not generating apply_delta" << std::endl;
+        version_.clear();
+      }
+      else if (! unique_index() || layout_ != "rows" || allocation_ == "arena" ||
+               has_flat_indices()) {
+        log_ << class_name_ << " apply_delta needs a unique index, the rows "
+             << "layout, shared allocation and node indices, "
+             << "not generating it" << std::endl;
+        version_.clear();
+      }
+    }
+
     std::string path = "./" + class_name_ + ".hpp";
-    ofs_.open(path);
+    ofs_.str(std::string());
     declare_prologue();
 
     instance_maker im(ofs_, shared_from_this());
     im.make();
+    if (layout_ == "columnar") {
+      columns_maker cm(ofs_, shared_from_this());
+      cm.make();
+    }
     // if (needs_mapping_) {
       mapping_maker mm(ofs_, shared_from_this());
-      mm.make();
+      if (compilation_ == "split") {
+        mm.declare();
+      }
+      else {
+        mm.make();
+      }
     // }
     ofs_ << "}}" << std::endl;
-    ofs_.close();
+    if (compilation_ == "split") {
+      mm.declare_table_instantiation();
+    }
+    written_ = write_if_changed(path, ofs_.str());
+
+    if (compilation_ == "split") {
+      src_.str(std::string());
+      declare_source_prologue();
+      mapping_maker sm(src_, shared_from_this());
+      sm.implement();
+      src_ << "}}" << std::endl;
+      sm.implement_table_instantiation();
+      std::string source = "./" + class_name_ + ".cpp";
+      written_ = write_if_changed(source, without_inline(src_.str())) || written_;
+    }
+
+    if (benchmark_) {
+      bench_.str(std::string());
+      bench_maker bm(bench_, shared_from_this());
+      bm.make();
+      std::string bench = "./" + class_name_ + "_bench.cpp";
+      written_ = write_if_changed(bench, bench_.str()) || written_;
+    }
+  }
+
+  //////
+  /// the implementations are emitted for a header, in a .cpp they are
+  /// the one definition and lose their inline specifier
+  //////
+  inline std::string
+  component::
+  without_inline(const std::string& text) {
+
+    std::istringstream is(text);
+    std::string out;
+    std::string line;
+    while (std::getline(is, line)) {
+      if (line == "  inline") {
+        continue;
+      }
+      if (line.compare(0, 9, "  inline ") == 0) {
+        line.erase(2, 7);
+      }
+      out += line;
+      out += '\n';
+    }
+    return out;
+  }
+
+  inline bool
+  component::
+  write_if_changed(const std::string& path, const std::string& text) {
+
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (ifs && static_cast<std::size_t>(ifs.tellg()) == text.size()) {
+      std::string prior(text.size(), '\0');
+      ifs.seekg(0);
+      if (ifs.read(&prior[0], prior.size()) && prior == text) {
+        return false;
+      }
+    }
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs.write(text.data(), text.size());
+    return true;
+  }
+
+  inline std::string
+  component::
+  log() const {
+    return log_.str();
+  }
+
+  inline bool
+  component::
+  written() const {
+    return written_;
   }
 
+  //////
+  /// features add the headers they need to one set, so each is included
+  /// once, the standard library ahead of the rest
+  //////
   inline void
   component::
   declare_prologue() {
 
-    ofs_ << "#pragma once" << std::endl << std::endl
-         << "#include <set>" << std::endl
-         << "#include <string>" << std::endl
-         << "#include <memory>" << std::endl
-         << "#include <mutex>" << std::endl
-         << "#include <boost/multi_index_container.hpp>" << std::endl
-         << "#include <boost/multi_index/member.hpp>" << std::endl
-         << "#include <boost/multi_index/mem_fun.hpp>" << std::endl
-         << "#include <boost/multi_index/hashed_index.hpp>" << std::endl
-         << "#include <boost/multi_index/ordered_index.hpp>" << std::endl
-         << "#include <boost/multi_index/composite_key.hpp>" << std::endl
-         << "#include <boost/multi_index/indexed_by.hpp>" << std::endl
-         << "#include <db/connection.hpp>"
+    std::set<std::string> includes;
+    includes.insert("set");
+    includes.insert("string");
+    includes.insert("string_view");
+    includes.insert("functional");
+    includes.insert("memory");
+    includes.insert("mutex");
+    includes.insert("boost/multi_index_container.hpp");
+    includes.insert("boost/multi_index/member.hpp");
+    includes.insert("boost/multi_index/mem_fun.hpp");
+    includes.insert("boost/multi_index/hashed_index.hpp");
+    includes.insert("boost/multi_index/ordered_index.hpp");
+    includes.insert("boost/multi_index/composite_key.hpp");
+    includes.insert("boost/multi_index/indexed_by.hpp");
+    if (storage_ == "inline") {
+      includes.insert("type_traits");
+      includes.insert("framework/fixed_string.hpp");
+    }
+    if (has_encoded()) {
+      includes.insert("cstdint");
+      includes.insert("framework/dictionary.hpp");
+      if (storage_ != "inline") {
+        includes.insert("framework/fixed_string.hpp");
+      }
+    }
+    if (layout_ != "rows" || has_flat_indices()) {
+      includes.insert("algorithm");
+      includes.insert("cstdint");
+      includes.insert("numeric");
+      includes.insert("tuple");
+      includes.insert("vector");
+      includes.insert("framework/flat_search.hpp");
+    }
+    if (layout_ == "mapped") {
+      includes.insert("type_traits");
+      includes.insert("framework/image.hpp");
+    }
+    if (shared_memory_) {
+      includes.insert("atomic");
+      includes.insert("framework/shared_image.hpp");
+    }
+    if (allocation_ == "arena") {
+      includes.insert("memory_resource");
+      includes.insert("new");
+      includes.insert("type_traits");
+    }
+    bool ranges = false;
+    for (auto ndx : indices_) {
+      ranges = ranges || ndx->type() == "ordered-non-unique" || ndx->type() == "hashed-non-unique";
+    }
+    if (ranges && layout_ == "rows") {
+      includes.insert("framework/range.hpp");
+    }
+    bool hashed = false;
+    for (auto ndx : indices_) {
+      hashed = hashed || (ndx->type().compare(0, 6, "hashed") == 0 &&
+                          ndx->get_index_pairs().size() > 1);
+    }
+    if (hashed && layout_ == "rows") {
+      includes.insert("framework/hash.hpp");
+    }
+    if (batch_finders_) {
+      includes.insert("cstddef");
+      includes.insert("tuple");
+      includes.insert("vector");
+      includes.insert("framework/batch.hpp");
+    }
+    if (raw_finders_) {
+      includes.insert("atomic");
+      includes.insert("framework/epoch.hpp");
+    }
+    includes.insert("cstdint");
+    includes.insert("framework/snapshot.hpp");
+    if (has_bulk_load()) {
+      includes.insert("algorithm");
+      includes.insert("cstddef");
+      includes.insert("vector");
+      includes.insert("framework/bulk.hpp");
+    }
+    if (load_mode_ == "pipelined") {
+      includes.insert("chrono");
+      includes.insert("thread");
+      includes.insert("vector");
+      includes.insert("framework/pipeline.hpp");
+    }
+    if (! partition_parameter().first.empty()) {
+      includes.insert("functional");
+      includes.insert("future");
+      includes.insert("vector");
+      includes.insert("framework/sql.hpp");
+    }
+    if (has_writer()) {
+      includes.insert("chrono");
+      includes.insert("cstddef");
+      includes.insert("functional");
+      includes.insert("future");
+      includes.insert("vector");
+      includes.insert("framework/write_behind.hpp");
+    }
+    if (! version_.empty() && concurrency_ == "mutex") {
+      includes.insert("atomic");
+    }
+    if (has_refresh()) {
+      includes.insert("atomic");
+      includes.insert("chrono");
+      includes.insert("functional");
+      includes.insert("framework/refresher.hpp");
+    }
+    if (concurrency_ == "sharded") {
+      includes.insert("array");
+      includes.insert("vector");
+      includes.insert("boost/functional/hash.hpp");
+    }
+
+    ofs_ << "#pragma once" << std::endl << std::endl;
+    for (const auto& include : includes) {
+      if (include.find('/') == std::string::npos) {
+        ofs_ << "#include <" << include << ">" << std::endl;
+      }
+    }
+    for (const auto& include : includes) {
+      if (include.find('/') != std::string::npos) {
+        ofs_ << "#include <" << include << ">" << std::endl;
+      }
+    }
+    ofs_ << "#include <db/connection.hpp>"
          << std::endl << std::endl
          << "namespace rates {" << std::endl
          << "namespace generated {" << std::endl << std::endl
@@ -623,9 +1764,18 @@ namespace framework {
          << "  namespace mti = boost::multi_index;" << std::endl << std::endl;
   }
 
+  inline void
+  component::
+  declare_source_prologue() {
+
+    src_ << "#include \"" << class_name_ << ".hpp\"" << std::endl << std::endl
+         << "namespace rates {" << std::endl
+         << "namespace generated {" << std::endl << std::endl;
+  }
+
   inline
   instance_maker::
-  instance_maker(std::ofstream& ofs,
+  instance_maker(std::ostream& ofs,
                  component::ptr comp) :
     ofs_(ofs),
     component_(comp)
@@ -690,7 +1840,10 @@ namespace framework {
       if (i != 0) {
         ofs_ << std::string(ctor_len, ' ');
       }
-      if (fp->type() == "std::string") {
+      if (component_->is_fixed(fp) || component_->is_encoded(fp)) {
+        ofs_ << "std::string_view";
+      }
+      else if (fp->type() == "std::string") {
         ofs_ << "const std::string& ";
       }
       else {
@@ -721,13 +1874,29 @@ namespace framework {
 
     for (; p != q; ++p) {
       field::ptr fp = *p;
-      if (fp->type() == "std::string") {
-        ofs_ << "    const std::string& ";
+      ofs_ << "    " << component_->value_type(fp) << " "
+           << fp->name() << "() const;" << std::endl;
+    }
+    ofs_ << std::endl;
+
+    if (! component_->has_encoded()) {
+      return;
+    }
+    ofs_ << "    //////" << std::endl
+         << "    /// dictionary codes, what indices on those fields compare, and the"
+         << std::endl
+         << "    /// dictionaries shared by every row" << std::endl
+         << "    //////" << std::endl;
+    for (auto fld : component_->get_fields()) {
+      if (component_->is_encoded(fld)) {
+        ofs_ << "    std::uint32_t " << fld->name() << "_code() const;" << std::endl;
       }
-      else {
-        ofs_ << "    " << fp->type() << " ";
+    }
+    for (auto fld : component_->get_fields()) {
+      if (component_->is_encoded(fld)) {
+        ofs_ << "    static framework::dictionary& " << fld->name() << "_dictionary();"
+             << std::endl;
       }
-      ofs_ << fp->name() << "() const;" << std::endl;
     }
     ofs_ << std::endl;
   }
@@ -744,14 +1913,8 @@ namespace framework {
     auto q = component_->get_fields().end();
     for (; p != q; ++p) {
       field::ptr fp = *p;
-      ofs_ << "    void " << fp->name() << "(";
-      if (fp->type() == "std::string") {
-        ofs_ << "const std::string&";
-      }
-      else {
-        ofs_ << fp->type();
-      }
-      ofs_ << ");" << std::endl;
+      ofs_ << "    void " << fp->name() << "("
+           << component_->value_type(fp) << ");" << std::endl;
     }
     ofs_ << std::endl;
   }
@@ -765,27 +1928,62 @@ namespace framework {
          << "    //////" << std::endl
          << "    void bind(connection_ptr conn);"
          << std::endl << std::endl;
+
+    if (component_->has_fetch_buffers()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// settle " << (component_->has_encoded() ? "fetch" : "inline")
+           << " buffers after the connection wrote a row" << std::endl
+           << "    //////" << std::endl
+           << "    void fetched();"
+           << std::endl << std::endl;
+    }
   }
 
   inline void
   instance_maker::
   declare_members() {
 
-    ofs_ << "  private:" << std::endl << std::endl
-         << "    //////" << std::endl
+    ofs_ << "  private:" << std::endl << std::endl;
+    if (component_->has_encoded()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// what the connection writes dictionary fields into, one per thread"
+           << std::endl
+           << "    //////" << std::endl;
+      for (auto fld : component_->get_fields()) {
+        if (component_->is_encoded(fld)) {
+          ofs_ << "    static framework::fixed_string<" << fld->size() << ">& "
+               << fld->name() << "_buffer();" << std::endl;
+        }
+      }
+      ofs_ << std::endl;
+    }
+    ofs_ << "    //////" << std::endl
          << "    /// class members" << std::endl
          << "    //////" << std::endl;
 
     auto p = component_->get_fields().begin();
     auto q = component_->get_fields().end();
-    const size_t flen = std::string("std::string").size();
+    size_t flen = std::string("std::string").size();
+    for (; p != q; ++p) {
+      flen = std::max(flen, component_->member_type(*p).size());
+    }
+    p = component_->get_fields().begin();
     for (; p != q; ++p) {
       field::ptr fp = *p;
-      std::string type = fp->type();
+      std::string type = component_->member_type(fp);
       ofs_ << "    " << type << std::string(flen - type.size(), ' ')
            << "  " << fp->name() << "_;" << std::endl;
     }
     ofs_ << "  };" << std::endl << std::endl;
+
+    if (component_->storage() == "inline" && component_->is_trivially_copyable()) {
+      std::string class_name = component_->class_name();
+      ofs_ << "  static_assert(std::is_trivially_copyable<" << class_name
+           << ">::value," << std::endl
+           << "                \"" << class_name
+           << " rows must stay one trivially copyable block\");"
+           << std::endl << std::endl;
+    }
   }
 
   inline void
@@ -812,7 +2010,13 @@ namespace framework {
       std::string type = fld->type();
       size_t size = fld->size();
       ofs_ << "    " << name << "_(";
-      if (type == "std::string") {
+      if (component_->is_fixed(fld)) {
+        ofs_ << ")";
+      }
+      else if (component_->is_encoded(fld)) {
+        ofs_ << "0)";
+      }
+      else if (type == "std::string") {
         ofs_ << size << ", '\\0')";
       }
       else {
@@ -846,7 +2050,10 @@ namespace framework {
       if (i != 0) {
         ofs_ << std::string(ctor_len, ' ');
       }
-      if (fp->type() == "std::string") {
+      if (component_->is_fixed(fp) || component_->is_encoded(fp)) {
+        ofs_ << "std::string_view";
+      }
+      else if (fp->type() == "std::string") {
         ofs_ << "const std::string& ";
       }
       else {
@@ -866,9 +2073,14 @@ namespace framework {
     i = 0;
     for (; p != q; ++p, ++i) {
       field::ptr fp = *p;
-      ofs_ << "    " << fp->name() << "_("
-           << fp->name()
-           << ")";
+      ofs_ << "    " << fp->name() << "_(";
+      if (component_->is_encoded(fp)) {
+        ofs_ << fp->name() << "_dictionary().intern(" << fp->name() << ")";
+      }
+      else {
+        ofs_ << fp->name();
+      }
+      ofs_ << ")";
       if (i < n - 1) {
         ofs_ << ",";
       }
@@ -896,7 +2108,10 @@ namespace framework {
 
       field::ptr fp = *p;
       ofs_ << "  inline ";
-      if (fp->type() == "std::string") {
+      if (component_->is_fixed(fp) || component_->is_encoded(fp)) {
+        ofs_ << "std::string_view";
+      }
+      else if (fp->type() == "std::string") {
         ofs_ << "const std::string& ";
       }
       else {
@@ -904,8 +2119,45 @@ namespace framework {
       }
       ofs_ << std::endl;
       ofs_ << "  " << class_name << "::" << std::endl
-           << "  " << fp->name() << "() const {" << std::endl
-           << "    return " << fp->name() << "_;" << std::endl
+           << "  " << fp->name() << "() const {" << std::endl;
+      if (component_->is_encoded(fp)) {
+        ofs_ << "    return " << fp->name() << "_dictionary().view(" << fp->name() << "_);"
+             << std::endl;
+      }
+      else {
+        ofs_ << "    return " << fp->name() << "_;" << std::endl;
+      }
+      ofs_ << "  }" << std::endl << std::endl;
+    }
+    if (! component_->has_encoded()) {
+      return;
+    }
+
+    ofs_ << "  //////" << std::endl
+         << "  /// dictionaries" << std::endl
+         << "  //////" << std::endl << std::endl;
+    for (auto fld : component_->get_fields()) {
+      if (! component_->is_encoded(fld)) {
+        continue;
+      }
+      std::string name = fld->name();
+      ofs_ << "  inline std::uint32_t" << std::endl
+           << "  " << class_name << "::" << std::endl
+           << "  " << name << "_code() const {" << std::endl
+           << "    return " << name << "_;" << std::endl
+           << "  }" << std::endl << std::endl
+           << "  inline framework::dictionary&" << std::endl
+           << "  " << class_name << "::" << std::endl
+           << "  " << name << "_dictionary() {" << std::endl
+           << "    static framework::dictionary  dictionary;" << std::endl
+           << "    return dictionary;" << std::endl
+           << "  }" << std::endl << std::endl
+           << "  inline framework::fixed_string<" << fld->size() << ">&" << std::endl
+           << "  " << class_name << "::" << std::endl
+           << "  " << name << "_buffer() {" << std::endl
+           << "    static thread_local framework::fixed_string<" << fld->size()
+           << ">  buffer;" << std::endl
+           << "    return buffer;" << std::endl
            << "  }" << std::endl << std::endl;
     }
   }
@@ -927,17 +2179,17 @@ namespace framework {
       field::ptr fp = *p;
       ofs_ << "  inline void" << std::endl
            << "  " << class_name << "::" << std::endl
-           << "  " << fp->name() << "(";
-      if (fp->type() == "std::string") {
-        ofs_ << "const std::string& ";
+           << "  " << fp->name() << "("
+           << component_->value_type(fp) << " "
+           << fp->name() << ") {" << std::endl;
+      if (component_->is_encoded(fp)) {
+        ofs_ << "    " << fp->name() << "_ = " << fp->name() << "_dictionary().intern("
+             << fp->name() << ");" << std::endl;
       }
       else {
-        ofs_ << fp->type() << " ";
+        ofs_ << "    " << fp->name() << "_ = " << fp->name() << ";" << std::endl;
       }
-      ofs_ << fp->name() << ") {" << std::endl
-           << "    " << fp->name() << "_ = "
-           << fp->name() << ";" << std::endl
-           << "  }" << std::endl << std::endl;
+      ofs_ << "  }" << std::endl << std::endl;
     }
   }
 
@@ -963,7 +2215,13 @@ namespace framework {
       ofs_ << "    conn->genericBind("
            << "\"" << fp->db_name() << "\""
            << ", ";
-      if (fp->type() == "std::string") {
+      if (component_->is_fixed(fp)) {
+        ofs_ << fp->name() << "_.data()";
+      }
+      else if (component_->is_encoded(fp)) {
+        ofs_ << fp->name() << "_buffer().data()";
+      }
+      else if (fp->type() == "std::string") {
         ofs_ << "&"
              << fp->name()
              << "_"
@@ -975,418 +2233,3943 @@ namespace framework {
       ofs_ << ");" << std::endl;
     }
     ofs_ << "  }" << std::endl << std::endl;
+
+    if (! component_->has_fetch_buffers()) {
+      return;
+    }
+    ofs_ << "  //////" << std::endl
+         << "  /// fetched" << std::endl
+         << "  //////" << std::endl
+         << "  inline void" << std::endl
+         << "  " << class_name << "::" << std::endl
+         << "  fetched() {" << std::endl;
+    p = component_->get_fields().begin();
+    for (; p != q; ++p) {
+      if (component_->is_fixed(*p)) {
+        ofs_ << "    " << (*p)->name() << "_.terminate();" << std::endl;
+      }
+      else if (component_->is_encoded(*p)) {
+        std::string name = (*p)->name();
+        ofs_ << "    " << name << "_buffer().terminate();" << std::endl
+             << "    " << name << "_ = " << name << "_dictionary().intern("
+             << name << "_buffer());" << std::endl;
+      }
+    }
+    ofs_ << "  }" << std::endl << std::endl;
   }
 
   inline
-  mapping_maker::
-  mapping_maker(std::ofstream& ofs,
+  columns_maker::
+  columns_maker(std::ostream& ofs,
                 component::ptr comp) :
     ofs_(ofs),
     component_(comp) {
   }
 
   inline void
-  mapping_maker::
+  columns_maker::
   make() {
-    declare_class();
-    declare_singleton_accessor();
-    declare_load();
-    declare_finders();
-    declare_members();
-    implement_singleton_accessor();
-    implement_load();
-    implement_finders();
+    declare_columns();
+    implement_columns();
+    declare_view();
+    implement_view();
   }
 
   inline void
-  mapping_maker::
-  declare_class() {
+  columns_maker::
+  declare_columns() {
 
     std::string class_name = component_->class_name();
+    std::string columns = class_name + "_columns";
     ofs_ << "  //////" << std::endl
-         << "  /// class " << class_name << "_mapping" << std::endl
+         << "  /// class " << columns << std::endl
          << "  //////" << std::endl
-         << "  class " << class_name << "_mapping {" << std::endl
-         << "  public:" << std::endl;
-    ofs_ << std::endl;
-  }
-
-  inline void
-  mapping_maker::
-  declare_singleton_accessor() {
-
-    std::string class_name = component_->class_name();
-    ofs_ << "    //////" << std::endl
-         << "    /// singleton accessor" << std::endl
+         << "  class " << columns << " {" << std::endl
+         << "  public:" << std::endl << std::endl
          << "    //////" << std::endl
-         << "    static " << class_name << "_mapping& instance();" << std::endl;
-    ofs_ << std::endl;
-  }
-
-  inline void
-  mapping_maker::
-  declare_load() {
-
-    std::string class_name = component_->class_name();
-    ofs_ << "    //////" << std::endl
-         << "    /// load" << std::endl
+         << "    /// number of rows" << std::endl
          << "    //////" << std::endl
-         << "    bool load(connection_ptr);" << std::endl;
-    ofs_ << std::endl;
-  }
-
-  inline void
-  mapping_maker::
-  declare_finders() {
+         << "    std::uint32_t size() const;" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// append one fetched row" << std::endl
+         << "    //////" << std::endl
+         << "    void push_back(const " << class_name << "& row);" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// cell accessors" << std::endl
+         << "    //////" << std::endl;
 
+    auto p = component_->get_fields().begin();
+    auto q = component_->get_fields().end();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      ofs_ << "    " << component_->value_type(fp) << " "
+           << fp->name() << "(std::uint32_t row) const;" << std::endl;
+    }
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// whole columns, for scans" << std::endl
+         << "    //////" << std::endl;
+    p = component_->get_fields().begin();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      ofs_ << "    const std::vector<" << component_->member_type(fp) << ">& "
+           << fp->name() << "_column() const;" << std::endl;
+    }
+    ofs_ << std::endl
+         << "  private:" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// one contiguous column per field" << std::endl
+         << "    //////" << std::endl;
+
+    size_t flen = 0;
+    p = component_->get_fields().begin();
+    for (; p != q; ++p) {
+      flen = std::max(flen, component_->member_type(*p).size());
+    }
+    p = component_->get_fields().begin();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      std::string type = component_->member_type(fp);
+      ofs_ << "    std::vector<" << type << ">" << std::string(flen - type.size(), ' ')
+           << "  " << fp->name() << "_;" << std::endl;
+    }
+    ofs_ << "  };" << std::endl << std::endl;
+  }
+
+  inline void
+  columns_maker::
+  implement_columns() {
+
+    std::string class_name = component_->class_name();
+    std::string columns = class_name + "_columns";
+    field::ptr first = component_->get_fields().front();
+    ofs_ << "  //////" << std::endl
+         << "  /// size" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::uint32_t" << std::endl
+         << "  " << columns << "::" << std::endl
+         << "  size() const {" << std::endl
+         << "    return static_cast<std::uint32_t>(" << first->name() << "_.size());"
+         << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// push_back" << std::endl
+         << "  //////" << std::endl
+         << "  inline void" << std::endl
+         << "  " << columns << "::" << std::endl
+         << "  push_back(const " << class_name << "& row) {" << std::endl;
+    auto p = component_->get_fields().begin();
+    auto q = component_->get_fields().end();
+    for (; p != q; ++p) {
+      ofs_ << "    " << (*p)->name() << "_.push_back(row." << (*p)->name() << "());"
+           << std::endl;
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// cell accessors" << std::endl
+         << "  //////" << std::endl << std::endl;
+    p = component_->get_fields().begin();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      ofs_ << "  inline " << component_->value_type(fp) << std::endl
+           << "  " << columns << "::" << std::endl
+           << "  " << fp->name() << "(std::uint32_t row) const {" << std::endl
+           << "    return " << fp->name() << "_[row];" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+
+    ofs_ << "  //////" << std::endl
+         << "  /// whole columns" << std::endl
+         << "  //////" << std::endl << std::endl;
+    p = component_->get_fields().begin();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      ofs_ << "  inline const std::vector<" << component_->member_type(fp) << ">&"
+           << std::endl
+           << "  " << columns << "::" << std::endl
+           << "  " << fp->name() << "_column() const {" << std::endl
+           << "    return " << fp->name() << "_;" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+  }
+
+  inline void
+  columns_maker::
+  declare_view() {
+
+    std::string class_name = component_->class_name();
+    std::string columns = class_name + "_columns";
+    std::string view = class_name + "_view";
+    ofs_ << "  //////" << std::endl
+         << "  /// class " << view << ", one row of a columnar table" << std::endl
+         << "  //////" << std::endl
+         << "  class " << view << " {" << std::endl
+         << "  public:" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// constructors, a default view refers to no row" << std::endl
+         << "    //////" << std::endl
+         << "    " << view << "();" << std::endl;
+    std::string ctor = "    " + view + "(";
+    ofs_ << ctor << "std::shared_ptr<const " << columns << "> columns," << std::endl
+         << std::string(ctor.size(), ' ') << "std::uint32_t row);" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// true when the view refers to a row" << std::endl
+         << "    //////" << std::endl
+         << "    explicit operator bool() const;" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// accessors" << std::endl
+         << "    //////" << std::endl;
+
+    auto p = component_->get_fields().begin();
+    auto q = component_->get_fields().end();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      ofs_ << "    " << component_->value_type(fp) << " "
+           << fp->name() << "() const;" << std::endl;
+    }
+    ofs_ << std::endl
+         << "  private:" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// class members" << std::endl
+         << "    //////" << std::endl;
+    std::string owner = "std::shared_ptr<const " + columns + ">";
+    ofs_ << "    " << owner << "  columns_;" << std::endl
+         << "    std::uint32_t" << std::string(owner.size() - 13, ' ') << "  row_;" << std::endl
+         << "  };" << std::endl << std::endl;
+  }
+
+  inline void
+  columns_maker::
+  implement_view() {
+
+    std::string class_name = component_->class_name();
+    std::string columns = class_name + "_columns";
+    std::string view = class_name + "_view";
+    ofs_ << "  //////" << std::endl
+         << "  /// constructors" << std::endl
+         << "  //////" << std::endl
+         << "  inline" << std::endl
+         << "  " << view << "::" << std::endl
+         << "  " << view << "() :" << std::endl
+         << "    row_(0) {" << std::endl
+         << "  }" << std::endl << std::endl;
+    std::string ctor = "  " + view + "(";
+    ofs_ << "  inline" << std::endl
+         << "  " << view << "::" << std::endl
+         << ctor << "std::shared_ptr<const " << columns << "> columns," << std::endl
+         << std::string(ctor.size(), ' ') << "std::uint32_t row) :" << std::endl
+         << "    columns_(std::move(columns))," << std::endl
+         << "    row_(row) {" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  inline" << std::endl
+         << "  " << view << "::" << std::endl
+         << "  operator bool() const {" << std::endl
+         << "    return columns_ != nullptr;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// accessors" << std::endl
+         << "  //////" << std::endl << std::endl;
+    auto p = component_->get_fields().begin();
+    auto q = component_->get_fields().end();
+    for (; p != q; ++p) {
+      field::ptr fp = *p;
+      ofs_ << "  inline " << component_->value_type(fp) << std::endl
+           << "  " << view << "::" << std::endl
+           << "  " << fp->name() << "() const {" << std::endl
+           << "    return columns_->" << fp->name() << "(row_);" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+  }
+
+  inline
+  mapping_maker::
+  mapping_maker(std::ostream& ofs,
+                component::ptr comp) :
+    ofs_(ofs),
+    component_(comp) {
+  }
+
+  inline void
+  mapping_maker::
+  make() {
+    declare();
+    implement();
+  }
+
+  inline void
+  mapping_maker::
+  declare() {
+    declare_class();
+    declare_singleton_accessor();
+    declare_load();
+    declare_writers();
+    declare_finders();
+    declare_members();
+    declare_bulk_members();
+    declare_snapshot_members();
+    declare_delta_members();
+    declare_pipeline_members();
+    declare_partition_members();
+    declare_writer_members();
+    declare_refresh_members();
+    declare_range_finders();
+    declare_class_end();
+  }
+
+  inline void
+  mapping_maker::
+  implement() {
+    implement_constructor();
+    implement_singleton_accessor();
+    implement_flat_table();
+    implement_generation();
+    implement_columnar_table();
+    implement_mapped_table();
+    implement_shard_of();
+    implement_load();
+    implement_load_stats();
+    implement_load_partitioned();
+    implement_snapshot();
+    implement_image();
+    implement_delta();
+    implement_refresh();
+    implement_writers();
+    implement_finders();
+    implement_raw_finders();
+    implement_batch_finders();
+    implement_range_finders();
+  }
+
+  inline void
+  mapping_maker::
+  declare_class() {
+
+    std::string class_name = component_->class_name();
+    ofs_ << "  //////" << std::endl
+         << "  /// class " << class_name << "_mapping" << std::endl
+         << "  //////" << std::endl
+         << "  class " << class_name << "_mapping {" << std::endl
+         << "  public:" << std::endl;
+    ofs_ << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_singleton_accessor() {
+
+    std::string class_name = component_->class_name();
+    ofs_ << "    //////" << std::endl
+         << "    /// singleton accessor" << std::endl
+         << "    //////" << std::endl
+         << "    static " << class_name << "_mapping& instance();" << std::endl;
+    ofs_ << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_load() {
+
+    std::string class_name = component_->class_name();
+    ofs_ << "    //////" << std::endl
+         << "    /// load" << std::endl;
+    if (component_->has_refresh()) {
+      ofs_ << "    ///" << std::endl
+           << "    /// the fingerprint is read first and kept, so the next refresh only"
+           << std::endl
+           << "    /// reloads when the database changed since" << std::endl;
+    }
+    ofs_ << "    //////" << std::endl
+         << "    bool load(connection_ptr);" << std::endl;
+    ofs_ << std::endl;
+
+    if (component_->load_mode() == "pipelined") {
+      ofs_ << "    //////" << std::endl
+           << "    /// stage times of the last load, one thread fetches rows while"
+           << std::endl
+           << "    /// another constructs them, only that overlaps, the indices are"
+           << std::endl
+           << "    /// built in bulk from all rows once the fetch has ended, so build"
+           << std::endl
+           << "    /// covers row construction and the whole index build" << std::endl
+           << "    //////" << std::endl
+           << "    framework::load_stats last_load_stats();" << std::endl;
+      ofs_ << std::endl;
+    }
+
+    ofs_ << "    //////" << std::endl
+         << "    /// warm restart, save writes the table to a binary file and load"
+         << std::endl
+         << "    /// reads one the way load does, files of another schema are refused"
+         << std::endl
+         << "    //////" << std::endl
+         << "    bool save_snapshot(const std::string& path);" << std::endl
+         << "    bool load_snapshot(const std::string& path);" << std::endl;
+    ofs_ << std::endl;
+
+    if (component_->layout() == "mapped") {
+      ofs_ << "    //////" << std::endl
+           << "    /// save writes the current image to a file, open maps one read only"
+           << std::endl
+           << "    /// in place of the table, finders then read the mapped pages" << std::endl
+           << "    //////" << std::endl
+           << "    bool save_image(const std::string& path);" << std::endl
+           << "    bool open_image(const std::string& path);" << std::endl;
+      ofs_ << std::endl;
+    }
+    if (component_->shared_memory()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// publish copies the current image into shared memory as the next"
+           << std::endl
+           << "    /// generation of name, follow serves finders from the generation last"
+           << std::endl
+           << "    /// published under name and moves to each later one as it appears,"
+           << std::endl
+           << "    /// false when nothing has been published under name" << std::endl
+           << "    //////" << std::endl
+           << "    bool publish(const std::string& name);" << std::endl
+           << "    bool follow(const std::string& name);" << std::endl;
+      ofs_ << std::endl;
+    }
+
+    stored_proc::parameter part = component_->partition_parameter();
+    if (! part.first.empty()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// partitioned load, one read per " << part.first
+           << " value runs concurrently on its" << std::endl
+           << "    /// own connection from connect, which must be thread safe, the rows"
+           << std::endl
+           << "    /// of all partitions then go into a fresh table that replaces the"
+           << std::endl
+           << "    /// current one, a row no partition returned is gone afterwards"
+           << std::endl
+           << "    //////" << std::endl
+           << "    bool load_partitioned(const std::vector<" << part.second
+           << ">& partitions," << std::endl
+           << "                          std::function<connection_ptr()> connect);"
+           << std::endl;
+      ofs_ << std::endl;
+    }
+
+    if (! component_->version().empty()) {
+      field::ptr ver = component_->get_field(component_->version());
+      ofs_ << "    //////" << std::endl
+           << "    /// delta load, applies the rows changed since the high water mark"
+           << std::endl;
+      if (component_->concurrency() == "snapshot") {
+        ofs_ << "    /// to a copy of the whole table it then publishes and advances it,"
+             << std::endl
+             << "    /// so a delta costs as much as the table, not as the rows it changes"
+             << std::endl;
+      }
+      else {
+        ofs_ << "    /// in place and advances it, the table is never refetched whole"
+             << std::endl;
+      }
+      if (component_->concurrency() == "mutex") {
+        ofs_ << "    /// but copied first while a range still holds it" << std::endl;
+      }
+      ofs_ << "    ///" << std::endl
+           << "    /// false when a unique index rejected a row, the others are applied"
+           << std::endl
+           << "    /// and the mark advances past it, a full load brings it back"
+           << std::endl
+           << "    //////" << std::endl
+           << "    bool apply_delta(connection_ptr);" << std::endl
+           << "    " << ver->type() << " high_water_mark();" << std::endl;
+      ofs_ << std::endl;
+    }
+
+    if (component_->has_refresh()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// refresh, reloads only when the fingerprint proc reports a change,"
+           << std::endl
+           << "    /// the background refresher calls it every period plus or minus jitter"
+           << std::endl
+           << "    /// with a connection from connect" << std::endl
+           << "    //////" << std::endl
+           << "    bool refresh(connection_ptr);" << std::endl
+           << "    void start_refresher(std::function<connection_ptr()> connect," << std::endl
+           << "                         std::chrono::milliseconds period," << std::endl
+           << "                         std::chrono::milliseconds jitter);" << std::endl
+           << "    void stop_refresher();" << std::endl << std::endl
+           << "    //////" << std::endl
+           << "    /// time since a load or refresh last found the table matching the"
+           << std::endl
+           << "    /// database, the duration's max until one has" << std::endl
+           << "    //////" << std::endl
+           << "    std::chrono::steady_clock::duration staleness() const;" << std::endl;
+      ofs_ << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  declare_finders() {
+
+    std::string class_name = component_->class_name();
+    ofs_ << "    //////" << std::endl
+         << "    /// finder methods" << std::endl;
+    if (component_->concurrency() == "sharded") {
+      ofs_ << "    ///" << std::endl
+           << "    /// the finder of an index rows are not sharded by asks the shards in"
+           << std::endl
+           << "    /// turn and returns the match of the first one holding any, which of"
+           << std::endl
+           << "    /// several rows matching a non-unique key that is depends on the shard"
+           << std::endl
+           << "    /// hash, not on load order, use find_all for every match" << std::endl;
+    }
+    ofs_ << "    //////" << std::endl;
+
+    auto p = component_->get_indices().begin();
+    auto q = component_->get_indices().end();
+    for (; p != q; ++p) {
+      index::ptr ndx = *p;
+      declare_key_parameters("    " + result_type() + " find_by_" + ndx->alias() + "(",
+                             ndx, ");");
+    }
+    ofs_ << std::endl;
+
+    if (component_->batch_finders()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// batch finder keys and methods, out[i] receives the row for keys[i]"
+           << std::endl
+           << "    //////" << std::endl;
+      size_t mlen = 0;
+      for (auto ndx : component_->get_indices()) {
+        mlen = std::max(mlen, ndx->alias().size());
+      }
+      for (auto ndx : component_->get_indices()) {
+        ofs_ << "    using " << ndx->alias() << "_key"
+             << std::string(mlen - ndx->alias().size(), ' ') << " = "
+             << batch_key_type(ndx) << ";" << std::endl;
+      }
+      for (auto ndx : component_->get_indices()) {
+        std::string lead = "    void find_by_" + ndx->alias() + "_batch(";
+        std::string indent(lead.size(), ' ');
+        ofs_ << lead << "const " << ndx->alias() << "_key* keys," << std::endl
+             << indent << "std::size_t count," << std::endl
+             << indent << result_type() << "* out);" << std::endl;
+      }
+      ofs_ << std::endl;
+    }
+
+    if (component_->raw_finders()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// raw finder methods, call inside a framework::epoch_guard,"
+           << std::endl
+           << "    /// the row stays valid until the guard is left" << std::endl
+           << "    //////" << std::endl;
+      for (auto ndx : component_->get_indices()) {
+        declare_key_parameters("    const " + class_name + "* find_by_" + ndx->alias()
+                               + "_raw(", ndx, ");");
+      }
+      ofs_ << std::endl;
+    }
+
+    if (component_->layout() == "columnar") {
+      ofs_ << "    //////" << std::endl
+           << "    /// the current columns, for whole table scans" << std::endl
+           << "    //////" << std::endl
+           << "    std::shared_ptr<const " << class_name << "_columns> columns();"
+           << std::endl << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  declare_writers() {
+
+    std::string class_name = component_->class_name();
+    if (component_->concurrency() == "sharded") {
+      index::ptr ndx = component_->unique_index();
+      ofs_ << "    //////" << std::endl
+           << "    /// point writers, each locks only the owning shard" << std::endl
+           << "    //////" << std::endl
+           << "    bool upsert(const " << class_name << "::ptr& row);" << std::endl;
+      declare_key_parameters("    bool erase_by_" + ndx->alias() + "(", ndx, ");");
+      ofs_ << std::endl;
+    }
+    if (component_->has_writer()) {
+      ofs_ << "    //////" << std::endl
+           << "    /// write behind, save and save_batch queue rows for the insert proc"
+           << std::endl
+           << "    /// and return at once, the writer thread executes what is queued in"
+           << std::endl
+           << "    /// exec batches of up to batch_size rows, waiting up to linger for a"
+           << std::endl
+           << "    /// batch to fill, a future turns true once its batch was executed,"
+           << std::endl
+           << "    /// the table sees saved rows on the next load" << std::endl
+           << "    //////" << std::endl
+           << "    void start_writer(std::function<connection_ptr()> connect," << std::endl
+           << "                      std::size_t batch_size," << std::endl
+           << "                      std::chrono::milliseconds linger);" << std::endl
+           << "    void stop_writer();" << std::endl
+           << "    std::future<bool> save(const " << class_name << "::ptr& row);"
+           << std::endl
+           << "    std::future<bool> save_batch(std::vector<" << class_name
+           << "::ptr> rows);" << std::endl;
+      ofs_ << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  declare_key_parameters(const std::string& lead,
+                         index::ptr ndx,
+                         const std::string& close) {
+
+    ofs_ << lead;
+    auto a = ndx->get_index_pairs().begin();
+    auto b = ndx->get_index_pairs().end();
+    size_t i = 0;
+    size_t n = std::distance(a, b);
+    for (; a != b; ++a, ++i) {
+
+      std::string index_name = a->first;
+      std::string index_type = a->second;
+      if (i != 0) {
+        ofs_ << std::string(lead.size(), ' ');
+      }
+      if (index_type == "std::string") {
+        ofs_ << "std::string_view ";
+      }
+      else {
+        ofs_ << index_type << " ";
+      }
+      ofs_ << index_name;
+      if (i < n - 1) {
+        ofs_ << ",";
+      }
+      else {
+        ofs_ << close;
+      }
+      ofs_ << std::endl;
+    }
+  }
+
+  inline std::string
+  mapping_maker::
+  key_arguments(index::ptr ndx,
+                const std::string& prefix,
+                const std::string& suffix,
+                const std::string& separator) {
+
+    std::string args;
+    auto a = ndx->get_index_pairs().begin();
+    auto b = ndx->get_index_pairs().end();
+    for (; a != b; ++a) {
+      if (! args.empty()) {
+        args += separator;
+      }
+      args += prefix + a->first + suffix;
+    }
+    return args;
+  }
+
+  inline std::string
+  mapping_maker::
+  key_type(const index::index_pair& key) {
+
+    field::ptr fld = component_->get_field(key.first);
+    if (fld && component_->is_encoded(fld)) {
+      return "std::uint32_t";
+    }
+    if (fld) {
+      return component_->value_type(fld);
+    }
+    if (key.second == "std::string") {
+      return "const std::string&";
+    }
+    return key.second;
+  }
+
+  inline std::string
+  mapping_maker::
+  key_member(const index::index_pair& key) {
+
+    field::ptr fld = component_->get_field(key.first);
+    if (fld && component_->is_encoded(fld)) {
+      return key.first + "_code";
+    }
+    return key.first;
+  }
+
+  inline std::string
+  mapping_maker::
+  key_code(const index::index_pair& key, const std::string& arg) {
+
+    field::ptr fld = component_->get_field(key.first);
+    if (fld && component_->is_encoded(fld)) {
+      return component_->class_name() + "::" + key.first + "_dictionary().code(" + arg + ")";
+    }
+    return arg;
+  }
+
+  inline std::string
+  mapping_maker::
+  key_tuple(index::ptr ndx) {
+
+    std::string tuple = "std::tuple<";
+    auto a = ndx->get_index_pairs().begin();
+    auto b = ndx->get_index_pairs().end();
+    for (size_t i = 0; a != b; ++a, ++i) {
+      if (i != 0) {
+        tuple += ", ";
+      }
+      tuple += a->second == "std::string" ? "std::string_view" : a->second;
+    }
+    return tuple + ">";
+  }
+
+  inline std::string
+  mapping_maker::
+  result_type() {
+
+    if (component_->layout() == "columnar") {
+      return component_->class_name() + "_view";
+    }
+    if (component_->layout() == "mapped") {
+      return "std::shared_ptr<const " + component_->class_name() + ">";
+    }
+    return component_->class_name() + "::ptr";
+  }
+
+  inline std::string
+  mapping_maker::
+  batch_key_type(index::ptr ndx) {
+
+    if (ndx->get_index_pairs().size() > 1) {
+      return key_tuple(ndx);
+    }
+    const std::string& type = ndx->get_index_pairs().front().second;
+    return type == "std::string" ? "std::string_view" : type;
+  }
+
+  inline std::string
+  mapping_maker::
+  batch_arguments(index::ptr ndx, const std::string& key) {
+
+    size_t n = ndx->get_index_pairs().size();
+    if (n == 1) {
+      return key;
+    }
+    std::string args;
+    for (size_t i = 0; i < n; ++i) {
+      if (i != 0) {
+        args += ", ";
+      }
+      args += "std::get<" + std::to_string(i) + ">(" + key + ")";
+    }
+    return args;
+  }
+
+  inline std::string
+  mapping_maker::
+  batch_lookup(index::ptr ndx, const std::string& key) {
+
+    const auto& keys = ndx->get_index_pairs();
+    if (keys.size() == 1) {
+      return key_code(keys.front(), key);
+    }
+    std::string args;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (i != 0) {
+        args += ", ";
+      }
+      args += key_code(keys[i], "std::get<" + std::to_string(i) + ">(" + key + ")");
+    }
+    return "boost::make_tuple(" + args + ")";
+  }
+
+  inline std::string
+  mapping_maker::
+  current_type() {
+
+    std::string class_name = component_->class_name();
+    if (component_->allocation() == "arena") {
+      return class_name + "_generation";
+    }
+    return class_name + "_table";
+  }
+
+  inline std::string
+  mapping_maker::
+  element_type() {
+
+    if (component_->allocation() == "arena") {
+      return component_->class_name() + "*";
+    }
+    return component_->class_name() + "::ptr";
+  }
+
+  inline std::string
+  mapping_maker::
+  element_parameter() {
+
+    if (component_->allocation() == "arena") {
+      return element_type() + " row";
+    }
+    return "const " + element_type() + "& row";
+  }
+
+  inline std::string
+  mapping_maker::
+  hold(const std::string& row) {
+
+    if (component_->allocation() == "arena") {
+      return component_->class_name() + "::ptr(generation, " + row + ")";
+    }
+    return row;
+  }
+
+  inline std::string
+  mapping_maker::
+  key_lookup(index::ptr ndx) {
+
+    std::string args;
+    for (const auto& key : ndx->get_index_pairs()) {
+      if (! args.empty()) {
+        args += ",";
+      }
+      args += key_code(key, key.first);
+    }
+    if (ndx->get_index_pairs().size() > 1) {
+      return "boost::make_tuple(" + args + ")";
+    }
+    return args;
+  }
+
+  inline void
+  mapping_maker::
+  declare_members() {
+
+    std::string class_name = component_->class_name();
+    ofs_ << "  private:" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// default constructor" << std::endl
+         << "    //////" << std::endl
+         << "    " << class_name << "_mapping"
+         << "();" << std::endl << std::endl;
+
+    if (component_->layout() == "columnar") {
+      declare_columnar_members();
+      return;
+    }
+    if (component_->layout() == "mapped") {
+      declare_mapped_members();
+      return;
+    }
+
+    ofs_ << "    //////" << std::endl
+         << "    /// boost multi-index tag definitions" << std::endl
+         << "    //////" << std::endl;
+
+    indices nodes = node_indices();
+    bool flat = component_->has_flat_indices();
+    std::string container = class_name + (flat ? "_nodes" : "_table");
+    if (nodes.empty()) {
+      declare_flat_table(nodes);
+      declare_table_members();
+      return;
+    }
+
+    auto a = nodes.begin();
+    auto b = nodes.end();
+    for (; a != b; ++a) {
+      index::ptr ndx = *a;
+      ofs_ << "    struct " << ndx->alias() << "_tag {};" << std::endl;
+    }
+    ofs_ << std::endl;
+    ofs_ << "    //////" << std::endl
+         << "    /// boost multi-index definition" << std::endl
+         << "    //////" << std::endl;
+    ofs_ << "    typedef mti::multi_index_container<" << std::endl
+         << "      " << element_type() << "," << std::endl
+         << "      mti::indexed_by<" << std::endl;
+
+    a = nodes.begin();
+    b = nodes.end();
+    size_t n = std::distance(a, b);
+    for (size_t i = 0; a != b; ++a, ++i) {
+
+      index::ptr ndx = *a;
+      std::string type = ndx->type();
+      std::string alias = ndx->alias();
+      size_t nkeys = ndx->get_index_pairs().size();
+      bool composite = nkeys > 1;
+      if (type == "ordered-unique") {
+        ofs_ << "        mti::ordered_unique<" << std::endl;
+      }
+      else if (type == "ordered-non-unique") {
+        ofs_ << "        mti::ordered_non_unique<" << std::endl;
+      }
+      else if (type == "hashed-unique") {
+        ofs_ << "        mti::hashed_unique<" << std::endl;
+      }
+      else if (type == "hashed-non-unique") {
+        ofs_ << "        mti::hashed_non_unique<" << std::endl;
+      }
+      ofs_ << "          mti::tag<"
+           << alias
+           << "_tag>,"
+           << std::endl;
+      if (! composite) {
+
+        auto c = ndx->get_index_pairs().begin();
+        std::string kname = key_member(*c);
+        std::string ktype = key_type(*c);
+        ofs_ << "          mti::const_mem_fun<"
+             << class_name
+             << ", "
+             << ktype
+             << ", &"
+             << class_name
+             << "::"
+             << kname
+             << ">";
+        bool ordered = type.compare(0, 7, "ordered") == 0;
+        if (ordered) {
+          ofs_ << "," << std::endl
+               << "          std::less<>";
+        }
+        else if (c->second == "std::string" && kname == c->first) {
+          ofs_ << "," << std::endl
+               << "          std::hash<std::string_view>," << std::endl
+               << "          std::equal_to<>";
+        }
+        ofs_ << std::endl;
+      }
+      else {
+        ofs_ << "          mti::composite_key<"
+             << std::endl
+             << "            "
+             << element_type()
+             << ","
+             << std::endl;
+
+        auto c = ndx->get_index_pairs().begin();
+        auto d = ndx->get_index_pairs().end();
+        size_t dn = std::distance(c, d);
+
+        for (size_t e = 0; c != d; ++c, ++e) {
+          std::string kname = key_member(*c);
+          std::string ktype = key_type(*c);
+          ofs_ << "            mti::const_mem_fun<"
+               << class_name
+               << ", "
+               << ktype
+               << ", &"
+               << class_name
+               << "::"
+               << kname
+               << ">";
+          if (e < dn - 1) {
+            ofs_ << ",";
+          }
+          ofs_ << std::endl;
+        }
+        ofs_ << "          >";
+        bool ordered = type.compare(0, 7, "ordered") == 0;
+        if (ordered) {
+          ofs_ << "," << std::endl
+               << "          mti::composite_key_compare<" << std::endl;
+          for (size_t e = 0; e < dn; ++e) {
+            ofs_ << "            std::less<>";
+            if (e < dn - 1) {
+              ofs_ << ",";
+            }
+            ofs_ << std::endl;
+          }
+          ofs_ << "          >";
+        }
+        else {
+          ofs_ << "," << std::endl
+               << "          mti::composite_key_hash<" << std::endl;
+          for (size_t e = 0; e < dn; ++e) {
+            ofs_ << "            framework::fast_hash" << (e < dn - 1 ? "," : "") << std::endl;
+          }
+          ofs_ << "          >," << std::endl
+               << "          mti::composite_key_equal_to<" << std::endl;
+          for (size_t e = 0; e < dn; ++e) {
+            ofs_ << "            std::equal_to<>" << (e < dn - 1 ? "," : "") << std::endl;
+          }
+          ofs_ << "          >";
+        }
+        ofs_ << std::endl;
+      }
+      ofs_ << "        >";
+      if (i < n - 1) {
+        ofs_ << ",";
+      }
+      ofs_ << std::endl;
+    }
+    if (component_->allocation() == "arena") {
+      ofs_ << "      >," << std::endl
+           << "      std::pmr::polymorphic_allocator<" << element_type() << ">"
+           << std::endl;
+    }
+    else {
+      ofs_ << "      >" << std::endl;
+    }
+    ofs_ << "    > " << container << ";" << std::endl;
+    ofs_ << std::endl;
+
+    ofs_ << "    //////" << std::endl
+         << "    /// boost multi-index indices" << std::endl
+         << "    //////" << std::endl;
+
+    a = nodes.begin();
+    b = nodes.end();
+    size_t mlen = 0;
+    for (; a != b; ++a) {
+      index::ptr ndx = *a;
+      if (ndx->alias().size() > mlen) {
+        mlen = ndx->alias().size();
+      }
+    }
+    a = nodes.begin();
+    b = nodes.end();
+    for (; a != b; ++a) {
+      index::ptr ndx = *a;
+      ofs_ << "    using "
+           << ndx->alias()
+           << "_index"
+           << std::string(mlen - ndx->alias().size(), ' ')
+           << " = "
+           << container
+           << "::index<"
+           << ndx->alias()
+           << "_tag>::type;"
+           << std::endl;
+    }
+    ofs_ << std::endl;
+    if (flat) {
+      declare_flat_table(nodes);
+    }
+    declare_table_members();
+  }
+
+  inline void
+  mapping_maker::
+  declare_table_members() {
+
+    std::string class_name = component_->class_name();
+    if (component_->concurrency() == "sharded") {
+      index::ptr ndx = component_->unique_index();
+      ofs_ << "    //////" << std::endl
+           << "    /// one lock stripe of the " << class_name << " table" << std::endl
+           << "    //////" << std::endl
+           << "    struct alignas(64) shard {" << std::endl
+           << "      std::mutex  lock_;" << std::endl
+           << "      " << class_name << "_table  table_;" << std::endl
+           << "    };" << std::endl << std::endl
+           << "    //////" << std::endl
+           << "    /// number of lock stripes" << std::endl
+           << "    //////" << std::endl
+           << "    static constexpr std::size_t shard_count = "
+           << component_->shards() << ";" << std::endl << std::endl
+           << "    //////" << std::endl
+           << "    /// selects the shard owning a " << ndx->alias() << " key" << std::endl
+           << "    //////" << std::endl;
+      declare_key_parameters("    static std::size_t shard_of(", ndx, ");");
+      ofs_ << std::endl
+           << "    //////" << std::endl
+           << "    /// the " << class_name << " table, striped by "
+           << ndx->alias() << std::endl
+           << "    //////" << std::endl
+           << "    std::array<shard, shard_count>  shards_;" << std::endl << std::endl
+           << "    //////" << std::endl
+           << "    /// serializes loaders, finders and writers lock one shard" << std::endl
+           << "    //////" << std::endl
+           << "    std::mutex  lock_;" << std::endl;
+      return;
+    }
+    if (component_->allocation() == "arena") {
+      declare_generation();
+      return;
+    }
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    //////" << std::endl
+           << "    /// the current immutable "
+           << class_name
+           << " table, swapped whole by load" << std::endl
+           << "    //////" << std::endl;
+      ofs_ << "    std::shared_ptr<const "
+           << class_name
+           << "_table>  "
+           << class_name
+           << "_table_;"
+           << std::endl
+           << std::endl;
+      declare_raw_current();
+      ofs_ << "    //////" << std::endl
+           << "    /// serializes loaders, finders never take it" << std::endl
+           << "    //////" << std::endl
+           << "    std::mutex  lock_;" << std::endl;
+      return;
+    }
+    ofs_ << "    //////" << std::endl
+         << "    /// the "
+         << class_name
+         << " table, replaced whole by load, a range keeps the one" << std::endl
+         << "    /// it came from alive" << std::endl
+         << "    //////" << std::endl;
+    ofs_ << "    std::shared_ptr<"
+         << class_name
+         << "_table>  "
+         << class_name
+         << "_table_;"
+         << std::endl
+         << std::endl;
+    ofs_ << "    //////" << std::endl
+         << "    /// synchronizes access to singleton data" << std::endl
+         << "    //////" << std::endl
+         << "    std::mutex  lock_;" << std::endl;
+  }
+
+  inline bool
+  mapping_maker::
+  has_range(index::ptr ndx) {
+
+    return component_->layout() == "rows" &&
+      (ndx->type() == "ordered-non-unique" || ndx->type() == "hashed-non-unique");
+  }
+
+  inline void
+  mapping_maker::
+  declare_delta_members() {
+
+    if (component_->version().empty()) {
+      return;
+    }
+    field::ptr ver = component_->get_field(component_->version());
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// the highest " << ver->name() << " loaded so far, guarded by lock_"
+         << std::endl
+         << "    //////" << std::endl
+         << "    " << ver->type() << "  high_water_mark_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_bulk_members() {
+
+    if (! component_->has_bulk_load()) {
+      return;
+    }
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// rows fetched by the last load, sizes the next one, guarded by lock_"
+         << std::endl
+         << "    //////" << std::endl
+         << "    std::size_t  loaded_rows_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_snapshot_members() {
+
+    std::ostringstream hash;
+    hash << std::hex << component_->schema_hash();
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// hash of the generator release and the fields snapshot files are"
+         << std::endl
+         << "    /// written with" << std::endl
+         << "    //////" << std::endl
+         << "    static constexpr std::uint64_t  snapshot_schema = 0x" << hash.str()
+         << "ull;" << std::endl;
+    if (component_->layout() == "mapped") {
+      std::ostringstream image;
+      image << std::hex << component_->image_hash();
+      ofs_ << std::endl
+           << "    //////" << std::endl
+           << "    /// hash of the fields and indices images are laid out for" << std::endl
+           << "    //////" << std::endl
+           << "    static constexpr std::uint64_t  image_schema = 0x" << image.str()
+           << "ull;" << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  declare_pipeline_members() {
+
+    if (component_->load_mode() != "pipelined") {
+      return;
+    }
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// stage times of the last load, guarded by lock_" << std::endl
+         << "    //////" << std::endl
+         << "    framework::load_stats  load_stats_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_partition_members() {
+
+    stored_proc::parameter part = component_->partition_parameter();
+    if (part.first.empty()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// reads one partition into rows, runs on a load_partitioned thread"
+         << std::endl
+         << "    //////" << std::endl
+         << "    static bool fetch_partition(connection_ptr conn," << std::endl
+         << "                                const " << part.second << "& partition,"
+         << std::endl
+         << "                                std::vector<" << class_name << ">& rows);"
+         << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_writer_members() {
+
+    if (! component_->has_writer()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// renders rows as one exec batch of the insert proc and executes it"
+         << std::endl
+         << "    //////" << std::endl
+         << "    static bool insert_rows(connection_ptr conn," << std::endl
+         << "                            const " << class_name << "::ptr* rows,"
+         << std::endl
+         << "                            std::size_t count);" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the write behind queue, swapped whole by start and stop" << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<framework::write_behind<" << class_name
+         << "::ptr>>  writer_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_refresh_members() {
+
+    if (! component_->has_refresh()) {
+      return;
+    }
+    std::string refresher = "std::unique_ptr<framework::periodic_refresher>";
+    std::string verified = "std::atomic<std::chrono::steady_clock::rep>";
+    size_t len = refresher.size();
+    ofs_ << std::endl
+         << "    //////" << std::endl
+         << "    /// the rows of the read proc, load once it has the fingerprint"
+         << std::endl
+         << "    //////" << std::endl
+         << "    bool load_rows(connection_ptr conn);" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the first row of the fingerprint proc, the rest are drained"
+         << std::endl
+         << "    //////" << std::endl
+         << "    bool read_fingerprint(connection_ptr conn, int& rows, std::string& checksum);"
+         << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the last fingerprint seen and when the table last matched it,"
+         << std::endl
+         << "    /// 0 until it first has" << std::endl
+         << "    //////" << std::endl
+         << "    int" << std::string(len - 3, ' ') << "  fingerprint_rows_;" << std::endl
+         << "    std::string" << std::string(len - 11, ' ') << "  fingerprint_checksum_;"
+         << std::endl
+         << "    " << verified << std::string(len - verified.size(), ' ')
+         << "  verified_;" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// serializes refresh and the refresher's start and stop" << std::endl
+         << "    //////" << std::endl
+         << "    std::mutex" << std::string(len - 10, ' ') << "  refresh_lock_;"
+         << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the background refresher, declared last so it stops first" << std::endl
+         << "    //////" << std::endl
+         << "    " << refresher << "  refresher_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_range_finders() {
+
+    indices ranged;
+    size_t mlen = 0;
+    for (auto ndx : component_->get_indices()) {
+      if (has_range(ndx)) {
+        ranged.push_back(ndx);
+        mlen = std::max(mlen, ndx->alias().size());
+      }
+    }
+    if (ranged.empty()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    bool sharded = component_->concurrency() == "sharded";
+    ofs_ << std::endl
+         << "  public:" << std::endl << std::endl
+         << "    //////" << std::endl;
+    bool copied = sharded;
+    std::string owner = "std::shared_ptr<const " + class_name + "_table>";
+    if (sharded) {
+      owner = "std::shared_ptr<const std::vector<" + element_type() + ">>";
+    }
+    else if (component_->allocation() == "arena") {
+      owner = "std::shared_ptr<const " + class_name + "_generation>";
+    }
+    if (sharded) {
+      ofs_ << "    /// range finders for the non-unique indices, they visit every shard,"
+           << std::endl
+           << "    /// a range holds the row handles of all shards in shard order, each"
+           << std::endl
+           << "    /// shard copied under its lock, so no lock is held while it lives"
+           << std::endl;
+    }
+    else {
+      ofs_ << "    /// range finders for the non-unique indices, a range keeps the table"
+           << std::endl
+           << "    /// it came from alive, count and exists touch no rows" << std::endl;
+    }
+    ofs_ << "    //////" << std::endl;
+    for (auto ndx : ranged) {
+      std::string iterator = copied ? "std::vector<" + element_type() + ">::const_iterator"
+                                    : ndx->alias() + "_index::const_iterator";
+      ofs_ << "    using " << ndx->alias() << "_range"
+           << std::string(mlen - ndx->alias().size(), ' ')
+           << " = framework::range<" << iterator << ", "
+           << owner << ">;" << std::endl;
+    }
+    ofs_ << std::endl;
+    for (auto ndx : ranged) {
+      declare_key_parameters("    " + ndx->alias() + "_range find_all_by_" + ndx->alias()
+                             + "(", ndx, ");");
+      declare_key_parameters("    std::size_t count_by_" + ndx->alias() + "(", ndx, ");");
+      declare_key_parameters("    bool exists_by_" + ndx->alias() + "(", ndx, ");");
+    }
+  }
+
+  inline void
+  mapping_maker::
+  declare_class_end() {
+    ofs_ << "  };" << std::endl << std::endl;
+  }
+
+  inline indices
+  mapping_maker::
+  node_indices() {
+
+    indices nodes;
+    for (auto ndx : component_->get_indices()) {
+      if (! ndx->is_flat()) {
+        nodes.push_back(ndx);
+      }
+    }
+    return nodes;
+  }
+
+  inline void
+  mapping_maker::
+  declare_table_instantiation() {
+
+    if (! has_table_instantiation()) {
+      return;
+    }
+    ofs_ << std::endl
+         << "//////" << std::endl
+         << "/// the multi-index table is instantiated once, by the .cpp" << std::endl
+         << "//////" << std::endl
+         << "extern template class " << table_instantiation() << ";" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_table_instantiation() {
+
+    if (! has_table_instantiation()) {
+      return;
+    }
+    ofs_ << std::endl
+         << "//////" << std::endl
+         << "/// the multi-index table, declared extern by the header" << std::endl
+         << "//////" << std::endl
+         << "template class " << table_instantiation() << ";" << std::endl;
+  }
+
+  //////
+  /// an arena table is left implicit, an explicit instantiation would
+  /// also instantiate swap, which polymorphic allocators do not support
+  //////
+  inline bool
+  mapping_maker::
+  has_table_instantiation() {
+    return component_->layout() == "rows" && component_->allocation() != "arena" &&
+           ! node_indices().empty();
+  }
+
+  //////
+  /// the table spelled from its own typedefs, an explicit instantiation
+  /// names the template outside the generated namespace and may use the
+  /// private table type of the mapping
+  //////
+  inline std::string
+  mapping_maker::
+  table_instantiation() {
+
+    std::string class_name = component_->class_name();
+    std::string table = "rates::generated::" + class_name + "_mapping::" + class_name +
+                        (component_->has_flat_indices() ? "_nodes" : "_table");
+    return "boost::multi_index::multi_index_container<\n  " +
+           table + "::value_type,\n  " +
+           table + "::index_specifier_type_list,\n  " +
+           table + "::allocator_type>";
+  }
+
+  inline void
+  mapping_maker::
+  declare_generation() {
+
+    std::string class_name = component_->class_name();
+    std::string generation = class_name + "_generation";
+    std::string arena = "std::pmr::monotonic_buffer_resource";
+    std::string table = class_name + "_table";
+    size_t len = std::max(arena.size(), table.size() + 1);
+    ofs_ << "    //////" << std::endl
+         << "    /// one loaded " << class_name
+         << " table, its rows and index nodes come from" << std::endl
+         << "    /// the arena and are released in bulk with it" << std::endl
+         << "    //////" << std::endl
+         << "    struct " << generation << " {" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// constructor and destructor, the destructor only runs the row"
+         << std::endl
+         << "      /// destructors, the arena frees everything else" << std::endl
+         << "      //////" << std::endl
+         << "      " << generation << "();" << std::endl
+         << "      ~" << generation << "();" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// the arena and the table placed in it, the table is never"
+         << std::endl
+         << "      /// destroyed since all it owns lives in the arena" << std::endl
+         << "      //////" << std::endl
+         << "      " << arena << std::string(len - arena.size(), ' ') << "  arena;"
+         << std::endl
+         << "      " << table << "&" << std::string(len - table.size() - 1, ' ')
+         << "  table;" << std::endl
+         << "    };" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the current generation" << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<const " << generation << "> current();"
+         << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the " << class_name << " table, replaced whole by load" << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<const " << generation << ">  " << generation << "_;"
+         << std::endl << std::endl;
+    declare_raw_current();
+    ofs_ << "    //////" << std::endl;
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    /// serializes loaders, finders never take it" << std::endl;
+    }
+    else {
+      ofs_ << "    /// synchronizes access to singleton data" << std::endl;
+    }
+    ofs_ << "    //////" << std::endl
+         << "    std::mutex  lock_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_raw_current() {
+
+    if (! component_->raw_finders()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    ofs_ << "    //////" << std::endl
+         << "    /// the same table for raw finders, the one it replaces is retired"
+         << std::endl
+         << "    /// through the epoch domain, whose reclaimer frees it soon after"
+         << std::endl
+         << "    /// the last guard that may see it is left" << std::endl
+         << "    //////" << std::endl
+         << "    std::atomic<const " << current_type() << "*>  " << class_name
+         << "_current_;" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_generation() {
+
+    if (component_->allocation() != "arena") {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    std::string generation = mapping + "::" + class_name + "_generation";
+    ofs_ << "  //////" << std::endl
+         << "  /// generation" << std::endl
+         << "  //////" << std::endl << std::endl
+         << "  inline" << std::endl
+         << "  " << generation << "::" << std::endl
+         << "  " << class_name << "_generation() :" << std::endl
+         << "    arena()," << std::endl
+         << "    table(*new (arena.allocate(sizeof(" << class_name << "_table), alignof("
+         << class_name << "_table)))" << std::endl
+         << "          " << class_name << "_table(&arena)) {" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  inline" << std::endl
+         << "  " << generation << "::" << std::endl
+         << "  ~" << class_name << "_generation() {" << std::endl
+         << "    if constexpr (! std::is_trivially_destructible<" << class_name
+         << ">::value) {" << std::endl
+         << "      for (" << element_type() << " row : "
+         << (component_->has_flat_indices() ? "table.rows" : "table") << ") {"
+         << std::endl
+         << "        row->~" << class_name << "();" << std::endl
+         << "      }" << std::endl
+         << "    }" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// current" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::shared_ptr<const " << generation << ">" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  current() {" << std::endl;
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    return std::atomic_load(&" << class_name << "_generation_);"
+           << std::endl;
+    }
+    else {
+      ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+           << "    return " << class_name << "_generation_;" << std::endl;
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_flat_table(const indices& nodes) {
+
+    std::string class_name = component_->class_name();
+    std::string table = class_name + "_table";
+    bool arena = component_->allocation() == "arena";
+    ofs_ << "    //////" << std::endl
+         << "    /// the " << class_name
+         << " table, flat indices hold row ids sorted by their" << std::endl
+         << "    /// key and are rebuilt once per load" << std::endl
+         << "    //////" << std::endl
+         << "    struct " << table << " {" << std::endl << std::endl;
+    if (arena) {
+      ofs_ << "      //////" << std::endl
+           << "      /// constructor, nodes, rows and ids come from the arena" << std::endl
+           << "      //////" << std::endl
+           << "      explicit " << table << "(std::pmr::memory_resource* arena);"
+           << std::endl << std::endl;
+    }
+    ofs_ << "      //////" << std::endl
+         << "      /// flat index keys" << std::endl
+         << "      //////" << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      if (ndx->is_flat()) {
+        ofs_ << "      using " << ndx->alias() << "_key = " << key_tuple(ndx) << ";"
+             << std::endl;
+      }
+    }
+    ofs_ << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      if (ndx->is_flat()) {
+        ofs_ << "      static " << ndx->alias() << "_key " << ndx->alias()
+             << "_of(" << element_parameter() << ");" << std::endl;
+      }
+    }
+    ofs_ << std::endl
+         << "      //////" << std::endl;
+    if (! nodes.empty()) {
+      ofs_ << "      /// node index access and row insertion" << std::endl
+           << "      //////" << std::endl
+           << "      template <typename Tag> auto& get();" << std::endl
+           << "      template <typename Tag> const auto& get() const;" << std::endl;
+    }
+    else {
+      ofs_ << "      /// row insertion" << std::endl
+           << "      //////" << std::endl;
+    }
+    ofs_ << "      bool insert(" << element_parameter() << ");" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// rebuilds the flat indices from the rows" << std::endl
+         << "      //////" << std::endl
+         << "      void build();" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// rows and indices" << std::endl
+         << "      //////" << std::endl;
+    std::string nodes_type = class_name + "_nodes";
+    std::string rows = (arena ? "std::pmr::vector<" : "std::vector<") + element_type() + ">";
+    std::string ids = arena ? "std::pmr::vector<std::uint32_t>" : "std::vector<std::uint32_t>";
+    size_t len = std::max(rows.size(), ids.size());
+    if (! nodes.empty()) {
+      len = std::max(len, nodes_type.size());
+      ofs_ << "      " << nodes_type << std::string(len - nodes_type.size(), ' ')
+           << "  nodes;" << std::endl;
+    }
+    ofs_ << "      " << rows << std::string(len - rows.size(), ' ') << "  rows;"
+         << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      if (ndx->is_flat()) {
+        ofs_ << "      " << ids << std::string(len - ids.size(), ' ') << "  "
+             << ndx->alias() << "_ids;" << std::endl;
+      }
+    }
+    ofs_ << "    };" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_flat_table() {
+
+    if (component_->layout() != "rows" || ! component_->has_flat_indices()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string table = class_name + "_mapping::" + class_name + "_table";
+    bool all_flat = true;
+    for (auto ndx : component_->get_indices()) {
+      all_flat = all_flat && ndx->is_flat();
+    }
+    if (component_->allocation() == "arena") {
+      ofs_ << "  //////" << std::endl
+           << "  /// constructor" << std::endl
+           << "  //////" << std::endl
+           << "  inline" << std::endl
+           << "  " << table << "::" << std::endl
+           << "  " << class_name << "_table(std::pmr::memory_resource* arena) :"
+           << std::endl;
+      if (! all_flat) {
+        ofs_ << "    nodes(arena)," << std::endl;
+      }
+      ofs_ << "    rows(arena)";
+      for (auto ndx : component_->get_indices()) {
+        if (ndx->is_flat()) {
+          ofs_ << "," << std::endl
+               << "    " << ndx->alias() << "_ids(arena)";
+        }
+      }
+      ofs_ << " {" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+    ofs_ << "  //////" << std::endl
+         << "  /// flat index keys" << std::endl
+         << "  //////" << std::endl << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      if (! ndx->is_flat()) {
+        continue;
+      }
+      std::string alias = ndx->alias();
+      ofs_ << "  inline " << table << "::" << alias << "_key" << std::endl
+           << "  " << table << "::" << std::endl
+           << "  " << alias << "_of(" << element_parameter() << ") {" << std::endl
+           << "    return " << alias << "_key("
+           << key_arguments(ndx, "row->", "()", ", ") << ");" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+
+    if (! all_flat) {
+      ofs_ << "  //////" << std::endl
+           << "  /// node index access" << std::endl
+           << "  //////" << std::endl << std::endl
+           << "  template <typename Tag>" << std::endl
+           << "  inline auto&" << std::endl
+           << "  " << table << "::" << std::endl
+           << "  get() {" << std::endl
+           << "    return nodes.get<Tag>();" << std::endl
+           << "  }" << std::endl << std::endl
+           << "  template <typename Tag>" << std::endl
+           << "  inline const auto&" << std::endl
+           << "  " << table << "::" << std::endl
+           << "  get() const {" << std::endl
+           << "    return nodes.get<Tag>();" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+    ofs_ << "  //////" << std::endl
+         << "  /// insert" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << table << "::" << std::endl
+         << "  insert(" << element_parameter() << ") {" << std::endl;
+    if (all_flat) {
+      ofs_ << "    rows.push_back(row);" << std::endl
+           << "    return true;" << std::endl;
+    }
+    else {
+      ofs_ << "    return nodes.insert(row).second;" << std::endl;
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// build" << std::endl
+         << "  //////" << std::endl
+         << "  inline void" << std::endl
+         << "  " << table << "::" << std::endl
+         << "  build() {" << std::endl;
+    if (! all_flat) {
+      ofs_ << std::endl
+           << "    rows.assign(nodes.begin(), nodes.end());" << std::endl;
+    }
+    for (auto ndx : component_->get_indices()) {
+      if (! ndx->is_flat()) {
+        continue;
+      }
+      std::string ids = ndx->alias() + "_ids";
+      std::string of = ndx->alias() + "_of";
+      ofs_ << std::endl
+           << "    " << ids << ".resize(rows.size());" << std::endl
+           << "    std::iota(" << ids << ".begin(), " << ids << ".end(), 0);" << std::endl
+           << "    std::stable_sort(" << ids << ".begin(), " << ids << ".end()," << std::endl
+           << "                     [this](std::uint32_t a, std::uint32_t b) {" << std::endl
+           << "                       return " << of << "(rows[a]) < " << of
+           << "(rows[b]);" << std::endl
+           << "                     });" << std::endl;
+      if (ndx->type() == "eytzinger") {
+        ofs_ << "    " << ids << " = framework::eytzinger_layout(" << ids << ");"
+             << std::endl;
+      }
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_columnar_members() {
+
+    std::string class_name = component_->class_name();
+    std::string table = class_name + "_table";
+    ofs_ << "    //////" << std::endl
+         << "    /// the columnar " << class_name
+         << " table, each index is a vector of row ids" << std::endl
+         << "    /// sorted by its key" << std::endl
+         << "    //////" << std::endl
+         << "    struct " << table << " {" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// index keys" << std::endl
+         << "      //////" << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      ofs_ << "      using " << ndx->alias() << "_key = " << key_tuple(ndx) << ";"
+           << std::endl;
+    }
+    ofs_ << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      ofs_ << "      " << ndx->alias() << "_key " << ndx->alias()
+           << "_of(std::uint32_t row) const;" << std::endl;
+    }
+    ofs_ << std::endl
+         << "      //////" << std::endl
+         << "      /// sorts every index once the columns are filled" << std::endl
+         << "      //////" << std::endl
+         << "      void build();" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// columns and indices" << std::endl
+         << "      //////" << std::endl;
+    std::string columns = class_name + "_columns";
+    size_t mlen = columns.size();
+    std::string ids = "std::vector<std::uint32_t>";
+    ofs_ << "      " << columns << std::string(std::max(mlen, ids.size()) - mlen, ' ')
+         << "  columns;" << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      ofs_ << "      " << ids << std::string(std::max(mlen, ids.size()) - ids.size(), ' ')
+           << "  " << ndx->alias() << "_ids;" << std::endl;
+    }
+    ofs_ << "    };" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the current table" << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<const " << table << "> current();" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the " << class_name << " table, replaced whole by load" << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<const " << table << ">  " << table << "_;"
+         << std::endl << std::endl
+         << "    //////" << std::endl;
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    /// serializes loaders, finders never take it" << std::endl;
+    }
+    else {
+      ofs_ << "    /// synchronizes access to singleton data" << std::endl;
+    }
+    ofs_ << "    //////" << std::endl
+         << "    std::mutex  lock_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  declare_mapped_members() {
+
+    std::string class_name = component_->class_name();
+    std::string table = class_name + "_table";
+    ofs_ << "    //////" << std::endl
+         << "    /// the mapped " << class_name
+         << " table, rows and per index row ids sorted by" << std::endl
+         << "    /// its key laid out in one image, on the heap after load or mapped"
+         << std::endl
+         << "    /// from a file after open_image" << std::endl
+         << "    //////" << std::endl
+         << "    struct " << table << " {" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// index keys" << std::endl
+         << "      //////" << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      ofs_ << "      using " << ndx->alias() << "_key = " << key_tuple(ndx) << ";"
+           << std::endl;
+    }
+    ofs_ << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      ofs_ << "      " << ndx->alias() << "_key " << ndx->alias()
+           << "_of(std::uint32_t row) const;" << std::endl;
+    }
+    ofs_ << std::endl
+         << "      //////" << std::endl
+         << "      /// build sorts every index and lays the rows out as a new image,"
+         << std::endl
+         << "      /// attach reads a table out of an image, nullptr when its sections"
+         << std::endl
+         << "      /// do not fit the rows" << std::endl
+         << "      //////" << std::endl
+         << "      static std::shared_ptr<const " << table << "> build(std::vector<"
+         << class_name << "> rows);" << std::endl
+         << "      static std::shared_ptr<const " << table
+         << "> attach(std::shared_ptr<const framework::image> image);" << std::endl << std::endl
+         << "      //////" << std::endl
+         << "      /// image, rows and indices" << std::endl
+         << "      //////" << std::endl;
+    std::string image = "std::shared_ptr<const framework::image>";
+    std::string rows = "framework::image_array<" + class_name + ">";
+    std::string ids = "framework::image_array<std::uint32_t>";
+    size_t mlen = std::max(image.size(), std::max(rows.size(), ids.size()));
+    ofs_ << "      " << image << std::string(mlen - image.size(), ' ') << "  image;" << std::endl
+         << "      " << rows << std::string(mlen - rows.size(), ' ') << "  rows;" << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      ofs_ << "      " << ids << std::string(mlen - ids.size(), ' ')
+           << "  " << ndx->alias() << "_ids;" << std::endl;
+    }
+    ofs_ << "    };" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the current table" << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<const " << table << "> current();" << std::endl << std::endl
+         << "    //////" << std::endl
+         << "    /// the " << class_name << " table, replaced whole by load and open_image"
+         << std::endl
+         << "    //////" << std::endl
+         << "    std::shared_ptr<const " << table << ">  " << table << "_;"
+         << std::endl << std::endl;
+    if (component_->shared_memory()) {
+      std::string follower = "std::shared_ptr<const framework::shared_follower>";
+      std::string followed = "std::atomic<std::uint64_t>";
+      ofs_ << "    //////" << std::endl
+           << "    /// moves the table to the last published generation, lock_ held"
+           << std::endl
+           << "    //////" << std::endl
+           << "    void keep_up();" << std::endl << std::endl
+           << "    //////" << std::endl
+           << "    /// the generations followed and the last one taken" << std::endl
+           << "    //////" << std::endl
+           << "    " << follower << "  follower_;" << std::endl
+           << "    " << followed << std::string(follower.size() - followed.size(), ' ')
+           << "  followed_;" << std::endl << std::endl;
+    }
+    ofs_ << "    //////" << std::endl;
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    /// serializes loaders, finders never take it" << std::endl;
+    }
+    else {
+      ofs_ << "    /// synchronizes access to singleton data" << std::endl;
+    }
+    ofs_ << "    //////" << std::endl
+         << "    std::mutex  lock_;" << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_mapped_table() {
+
+    if (component_->layout() != "mapped") {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    std::string table = mapping + "::" + class_name + "_table";
+    auto indices = component_->get_indices();
+    ofs_ << "  //////" << std::endl
+         << "  /// index keys" << std::endl
+         << "  //////" << std::endl << std::endl;
+    for (auto ndx : indices) {
+      std::string alias = ndx->alias();
+      ofs_ << "  inline " << table << "::" << alias << "_key" << std::endl
+           << "  " << table << "::" << std::endl
+           << "  " << alias << "_of(std::uint32_t row) const {" << std::endl
+           << "    return " << alias << "_key("
+           << key_arguments(ndx, "rows[row].", "()", ", ") << ");" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+
+    ofs_ << "  //////" << std::endl
+         << "  /// build" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::shared_ptr<const " << table << ">" << std::endl
+         << "  " << table << "::" << std::endl
+         << "  build(std::vector<" << class_name << "> rows) {" << std::endl << std::endl
+         << "    static_assert(std::is_trivially_copyable<" << class_name << ">::value," << std::endl
+         << "                  \"mapped rows are copied byte for byte\");" << std::endl;
+    for (auto ndx : indices) {
+      std::string ids = ndx->alias() + "_ids";
+      ofs_ << std::endl
+           << "    std::vector<std::uint32_t> " << ids << "(rows.size());" << std::endl
+           << "    std::iota(" << ids << ".begin(), " << ids << ".end(), 0);" << std::endl
+           << "    std::stable_sort(" << ids << ".begin(), " << ids << ".end()," << std::endl
+           << "                     [&rows](std::uint32_t a, std::uint32_t b) {" << std::endl
+           << "                       return " << ndx->alias() << "_key("
+           << key_arguments(ndx, "rows[a].", "()", ", ") << ") <" << std::endl
+           << "                              " << ndx->alias() << "_key("
+           << key_arguments(ndx, "rows[b].", "()", ", ") << ");" << std::endl
+           << "                     });" << std::endl;
+      if (ndx->type() == "eytzinger") {
+        ofs_ << "    " << ids << " = framework::eytzinger_layout(" << ids << ");"
+             << std::endl;
+      }
+    }
+    ofs_ << std::endl
+         << "    return attach(framework::image::build(image_schema, sizeof("
+         << class_name << "), rows.size(), {" << std::endl
+         << "      {rows.data(), rows.size() * sizeof(" << class_name << ")}";
+    for (auto ndx : indices) {
+      std::string ids = ndx->alias() + "_ids";
+      ofs_ << "," << std::endl
+           << "      {" << ids << ".data(), " << ids << ".size() * sizeof(std::uint32_t)}";
+    }
+    ofs_ << std::endl
+         << "    }));" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// attach, the row ids are trusted as written so opening costs"
+         << std::endl
+         << "  /// nothing per row" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::shared_ptr<const " << table << ">" << std::endl
+         << "  " << table << "::" << std::endl
+         << "  attach(std::shared_ptr<const framework::image> image) {" << std::endl << std::endl
+         << "    if (! image) {" << std::endl
+         << "      return nullptr;" << std::endl
+         << "    }" << std::endl
+         << "    auto table = std::make_shared<" << class_name << "_table>();" << std::endl
+         << "    table->image = image;" << std::endl
+         << "    table->rows = image->get<" << class_name << ">(0);" << std::endl
+         << "    std::size_t n = table->rows.size();" << std::endl
+         << "    if (n != image->rows()) {" << std::endl
+         << "      return nullptr;" << std::endl
+         << "    }" << std::endl;
+    size_t section = 1;
+    for (auto ndx : indices) {
+      std::string ids = "table->" + ndx->alias() + "_ids";
+      ofs_ << "    " << ids << " = image->get<std::uint32_t>(" << section++ << ");" << std::endl
+           << "    if (" << ids << ".size() != n"
+           << (ndx->type() == "eytzinger" ? " + 1" : "") << ") {" << std::endl
+           << "      return nullptr;" << std::endl
+           << "    }" << std::endl;
+    }
+    ofs_ << "    return table;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// current" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::shared_ptr<const " << table << ">" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  current() {" << std::endl;
+    if (component_->shared_memory() && component_->concurrency() == "snapshot") {
+      ofs_ << "    auto follower = std::atomic_load(&follower_);" << std::endl
+           << "    if (follower && follower->generation() != followed_.load()) {" << std::endl
+           << "      std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+           << "      keep_up();" << std::endl
+           << "    }" << std::endl
+           << "    return std::atomic_load(&" << class_name << "_table_);" << std::endl;
+    }
+    else if (component_->shared_memory()) {
+      ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+           << "    if (follower_ && follower_->generation() != followed_.load()) {" << std::endl
+           << "      keep_up();" << std::endl
+           << "    }" << std::endl
+           << "    return " << class_name << "_table_;" << std::endl;
+    }
+    else if (component_->concurrency() == "snapshot") {
+      ofs_ << "    return std::atomic_load(&" << class_name << "_table_);" << std::endl;
+    }
+    else {
+      ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+           << "    return " << class_name << "_table_;" << std::endl;
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_image() {
+
+    if (component_->layout() != "mapped") {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    size_t sections = component_->get_indices().size() + 1;
+    ofs_ << "  //////" << std::endl
+         << "  /// save_image" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  save_image(const std::string& path) {" << std::endl
+         << "    return current()->image->save(path);" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  //////" << std::endl
+         << "  /// open_image" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  open_image(const std::string& path) {" << std::endl << std::endl
+         << "    auto next = " << class_name << "_table::attach(framework::image::map("
+         << std::endl
+         << "      path, image_schema, sizeof(" << class_name << "), " << sections << "));"
+         << std::endl
+         << "    if (! next) {" << std::endl
+         << "      return false;" << std::endl
+         << "    }" << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl;
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    std::atomic_store(&" << class_name << "_table_, next);" << std::endl;
+    }
+    else {
+      ofs_ << "    " << class_name << "_table_ = next;" << std::endl;
+    }
+    ofs_ << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    if (! component_->shared_memory()) {
+      return;
+    }
+    bool snapshot = component_->concurrency() == "snapshot";
+    std::string table = class_name + "_table_";
+    ofs_ << "  //////" << std::endl
+         << "  /// publish" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  publish(const std::string& name) {" << std::endl
+         << "    return framework::publish_image(name, *current()->image);" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  //////" << std::endl
+         << "  /// follow" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  follow(const std::string& name) {" << std::endl << std::endl
+         << "    auto follower = std::make_shared<const framework::shared_follower>(name);"
+         << std::endl
+         << "    if (! *follower) {" << std::endl
+         << "      return false;" << std::endl
+         << "    }" << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl;
+    if (snapshot) {
+      ofs_ << "    std::atomic_store(&follower_, follower);" << std::endl;
+    }
+    else {
+      ofs_ << "    follower_ = follower;" << std::endl;
+    }
+    ofs_ << "    followed_.store(0);" << std::endl
+         << "    keep_up();" << std::endl
+         << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  //////" << std::endl
+         << "  /// keep_up, a generation that will not open is skipped and the" << std::endl
+         << "  /// table stays on the last one that did" << std::endl
+         << "  //////" << std::endl
+         << "  inline void" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  keep_up() {" << std::endl << std::endl
+         << "    for (;;) {" << std::endl
+         << "      std::uint64_t generation = follower_->generation();" << std::endl
+         << "      if (generation == followed_.load()) {" << std::endl
+         << "        return;" << std::endl
+         << "      }" << std::endl
+         << "      auto next = " << class_name << "_table::attach(follower_->open(" << std::endl
+         << "        generation, image_schema, sizeof(" << class_name << "), "
+         << sections << "));" << std::endl
+         << "      if (next) {" << std::endl;
+    if (snapshot) {
+      ofs_ << "        std::atomic_store(&" << table << ", next);" << std::endl;
+    }
+    else {
+      ofs_ << "        " << table << " = next;" << std::endl;
+    }
+    ofs_ << "      }" << std::endl
+         << "      // removed while it was opened, a later one is published" << std::endl
+         << "      else if (follower_->generation() != generation) {" << std::endl
+         << "        continue;" << std::endl
+         << "      }" << std::endl
+         << "      followed_.store(generation);" << std::endl
+         << "    }" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_columnar_table() {
+
+    if (component_->layout() != "columnar") {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    std::string table = mapping + "::" + class_name + "_table";
+    ofs_ << "  //////" << std::endl
+         << "  /// index keys" << std::endl
+         << "  //////" << std::endl << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      std::string alias = ndx->alias();
+      ofs_ << "  inline " << table << "::" << alias << "_key" << std::endl
+           << "  " << table << "::" << std::endl
+           << "  " << alias << "_of(std::uint32_t row) const {" << std::endl
+           << "    return " << alias << "_key("
+           << key_arguments(ndx, "columns.", "(row)", ", ") << ");" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+
+    ofs_ << "  //////" << std::endl
+         << "  /// build" << std::endl
+         << "  //////" << std::endl
+         << "  inline void" << std::endl
+         << "  " << table << "::" << std::endl
+         << "  build() {" << std::endl;
+    for (auto ndx : component_->get_indices()) {
+      std::string ids = ndx->alias() + "_ids";
+      std::string of = ndx->alias() + "_of";
+      ofs_ << std::endl
+           << "    " << ids << ".resize(columns.size());" << std::endl
+           << "    std::iota(" << ids << ".begin(), " << ids << ".end(), 0);" << std::endl
+           << "    std::stable_sort(" << ids << ".begin(), " << ids << ".end()," << std::endl
+           << "                     [this](std::uint32_t a, std::uint32_t b) {" << std::endl
+           << "                       return " << of << "(a) < " << of << "(b);" << std::endl
+           << "                     });" << std::endl;
+      if (ndx->type() == "eytzinger") {
+        ofs_ << "    " << ids << " = framework::eytzinger_layout(" << ids << ");"
+             << std::endl;
+      }
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// current" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::shared_ptr<const " << table << ">" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  current() {" << std::endl;
+    if (component_->concurrency() == "snapshot") {
+      ofs_ << "    return std::atomic_load(&" << class_name << "_table_);" << std::endl;
+    }
+    else {
+      ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+           << "    return " << class_name << "_table_;" << std::endl;
+    }
+    ofs_ << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// columns" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::shared_ptr<const " << class_name << "_columns>" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  columns() {" << std::endl
+         << "    auto table = current();" << std::endl
+         << "    return std::shared_ptr<const " << class_name
+         << "_columns>(table, &table->columns);" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_constructor() {
+
+    std::string class_name = component_->class_name();
+    ofs_ << "  //////" << std::endl
+         << "  /// default constructor" << std::endl
+         << "  //////" << std::endl
+         << "  inline" << std::endl
+         << "  " << class_name << "_mapping::" << std::endl
+         << "  " << class_name << "_mapping()";
+    std::vector<std::string> inits;
+    if (component_->allocation() == "arena") {
+      inits.push_back(class_name + "_generation_(std::make_shared<"
+                      + class_name + "_generation>())");
+    }
+    else if (component_->layout() == "mapped") {
+      inits.push_back(class_name + "_table_(" + class_name + "_table::build({}))");
+    }
+    else if (component_->concurrency() != "sharded") {
+      inits.push_back(class_name + "_table_(std::make_shared<"
+                      + class_name + "_table>())");
+    }
+    if (component_->raw_finders()) {
+      inits.push_back(class_name + "_current_(" + current_type() + "_.get())");
+    }
+    if (component_->shared_memory()) {
+      inits.push_back("followed_(0)");
+    }
+    if (component_->has_bulk_load()) {
+      inits.push_back("loaded_rows_(0)");
+    }
+    if (! component_->version().empty()) {
+      inits.push_back("high_water_mark_(0)");
+    }
+    if (component_->has_refresh()) {
+      inits.push_back("fingerprint_rows_(-1)");
+      inits.push_back("verified_(0)");
+    }
+    for (size_t i = 0; i < inits.size(); ++i) {
+      ofs_ << (i == 0 ? " :" : ",") << std::endl
+           << "    " << inits[i];
+    }
+    ofs_ << " {" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_singleton_accessor() {
+
+    std::string class_name = component_->class_name() + "_mapping";
+    ofs_ << "  //////" << std::endl
+         << "  /// singleton accessor" << std::endl
+         << "  //////" << std::endl
+         << "  inline " << class_name << "& " << std::endl
+         << "  " << class_name << "::" << std::endl
+         << "  instance() {" << std::endl
+         << "    static " << class_name << " instance_;" << std::endl
+         << "    return instance_;" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_shard_of() {
+
+    if (component_->concurrency() != "sharded") {
+      return;
+    }
+    std::string class_name = component_->class_name() + "_mapping";
+    index::ptr ndx = component_->unique_index();
+    ofs_ << "  //////" << std::endl
+         << "  /// shard selection" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::size_t" << std::endl
+         << "  " << class_name << "::" << std::endl;
+    declare_key_parameters("  shard_of(", ndx, ") {");
+    ofs_ << std::endl
+         << "    std::size_t seed = 0;" << std::endl;
+    auto a = ndx->get_index_pairs().begin();
+    auto b = ndx->get_index_pairs().end();
+    for (; a != b; ++a) {
+      ofs_ << "    boost::hash_combine(seed, " << a->first << ");" << std::endl;
+    }
+    ofs_ << "    return seed % shard_count;" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_load() {
+
+    std::string class_name = component_->class_name();
+    std::string name = component_->has_refresh() ? "load_rows" : "load";
+    ofs_ << "  //////" << std::endl
+         << "  /// " << name << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << class_name << "_mapping" << "::" << std::endl
+         << "  " << name << "(connection_ptr conn) {"
+         << std::endl << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);"
+         << std::endl;
+
+    const auto& sps = component_->get_stored_procs();
+    auto i = sps.find("read");
+    auto sp = i->second;
+    ofs_ << "    "
+         << "std::string sp = \"exec "
+         << sp->name()
+         << "\";"
+         << std::endl;
+    if (component_->load_mode() == "pipelined") {
+      ofs_ << "    int result = conn->execute(sp);" << std::endl
+           << "    if (result == FAIL) return false;" << std::endl << std::endl
+           << "    framework::spsc_ring<std::vector<" << class_name
+           << ">> ring(framework::pipeline_depth);" << std::endl
+           << "    framework::load_stats stats;" << std::endl
+           << "    framework::pipeline_fetcher<std::vector<" << class_name
+           << ">> fetcher(ring, [&conn, &ring, &stats] {" << std::endl
+           << "      auto start = std::chrono::steady_clock::now();" << std::endl
+           << "      " << class_name << " area;" << std::endl
+           << "      std::vector<" << class_name << "> batch;" << std::endl
+           << "      batch.reserve(framework::pipeline_batch);" << std::endl
+           << "      area.bind(conn);" << std::endl
+           << "      while (conn->nextRow() != NO_MORE_ROWS) {" << std::endl;
+      if (component_->has_fetch_buffers()) {
+        ofs_ << "        area.fetched();" << std::endl;
+      }
+      ofs_ << "        batch.push_back(area);" << std::endl
+           << "        if (batch.size() == framework::pipeline_batch) {" << std::endl
+           << "          stats.rows += batch.size();" << std::endl
+           << "          ++stats.batches;" << std::endl
+           << "          if (! ring.push(std::move(batch))) return;" << std::endl
+           << "          batch.clear();" << std::endl
+           << "          batch.reserve(framework::pipeline_batch);" << std::endl
+           << "        }" << std::endl
+           << "      }" << std::endl
+           << "      if (! batch.empty()) {" << std::endl
+           << "        stats.rows += batch.size();" << std::endl
+           << "        ++stats.batches;" << std::endl
+           << "        if (! ring.push(std::move(batch))) return;" << std::endl
+           << "      }" << std::endl
+           << "      stats.fetch = std::chrono::steady_clock::now() - start;" << std::endl
+           << "    });" << std::endl
+           << "    auto start = std::chrono::steady_clock::now();" << std::endl;
+      implement_build("pipeline");
+    }
+    else {
+      ofs_ << "    " << class_name << " area;" << std::endl
+           << "    int result = conn->execute(sp);" << std::endl
+           << "    if (result == FAIL) return false;" << std::endl << std::endl;
+      implement_build("connection");
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_snapshot() {
+
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    bool flat = component_->has_flat_indices();
+    ofs_ << "  //////" << std::endl
+         << "  /// snapshot save" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  save_snapshot(const std::string& path) {" << std::endl << std::endl
+         << "    framework::snapshot_writer out(path, snapshot_schema);" << std::endl
+         << "    std::uint64_t count = 0;" << std::endl;
+    if (component_->layout() == "mapped") {
+      ofs_ << "    auto table = current();" << std::endl
+           << "    for (const auto& row : table->rows) {" << std::endl;
+      implement_snapshot_write("      ", "row.", "()");
+      ofs_ << "      ++count;" << std::endl
+           << "    }" << std::endl;
+    }
+    else if (component_->layout() == "columnar") {
+      ofs_ << "    auto table = current();" << std::endl
+           << "    const auto& columns = table->columns;" << std::endl
+           << "    for (std::uint32_t i = 0; i < columns.size(); ++i, ++count) {"
+           << std::endl;
+      implement_snapshot_write("      ", "columns.", "(i)");
+      ofs_ << "    }" << std::endl;
+    }
+    else if (component_->concurrency() == "sharded") {
+      ofs_ << "    for (auto& s : shards_) {" << std::endl
+           << "      std::lock_guard<std::mutex>  shard_guard(s.lock_);" << std::endl
+           << "      for (const auto& row : s.table_" << (flat ? ".rows" : "") << ") {"
+           << std::endl;
+      implement_snapshot_write("        ", "row->", "()");
+      ofs_ << "        ++count;" << std::endl
+           << "      }" << std::endl
+           << "    }" << std::endl;
+    }
+    else {
+      std::string table = class_name + "_table_" + (flat ? ".rows" : "");
+      if (component_->allocation() == "arena") {
+        ofs_ << "    auto generation = current();" << std::endl;
+        table = std::string("generation->table") + (flat ? ".rows" : "");
+      }
+      else if (component_->concurrency() == "snapshot") {
+        ofs_ << "    auto table = std::atomic_load(&" << class_name << "_table_);"
+             << std::endl;
+        table = flat ? "table->rows" : "*table";
+      }
+      else {
+        ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl;
+        table = flat ? class_name + "_table_->rows" : "*" + class_name + "_table_";
+      }
+      ofs_ << "    for (const auto& row : " << table << ") {" << std::endl;
+      implement_snapshot_write("      ", "row->", "()");
+      ofs_ << "      ++count;" << std::endl
+           << "    }" << std::endl;
+    }
+    ofs_ << "    return out.commit(count);" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// snapshot load" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  load_snapshot(const std::string& path) {" << std::endl << std::endl
+         << "    framework::snapshot_reader in(path, snapshot_schema);" << std::endl
+         << "    if (! in) return false;" << std::endl << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+         << "    " << class_name << " area;" << std::endl;
+    implement_build("snapshot");
+  }
+
+  inline void
+  mapping_maker::
+  implement_snapshot_write(const std::string& indent,
+                           const std::string& prefix,
+                           const std::string& suffix) {
+
+    for (auto fld : component_->get_fields()) {
+      std::string value = prefix + fld->name() + suffix;
+      if (fld->type() == "std::string") {
+        ofs_ << indent << "out.write_string(" << value << ");" << std::endl;
+      }
+      else {
+        ofs_ << indent << "out.write(" << value << ");" << std::endl;
+      }
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_snapshot_read(const std::string& indent) {
+
+    for (auto fld : component_->get_fields()) {
+      ofs_ << indent << "area." << fld->name() << "(";
+      if (component_->is_fixed(fld) || component_->is_encoded(fld)) {
+        ofs_ << "in.read_string()";
+      }
+      else if (fld->type() == "std::string" && fld->size() > 0) {
+        ofs_ << "framework::padded(in.read_string(), " << fld->size() << ")";
+      }
+      else if (fld->type() == "std::string") {
+        ofs_ << "std::string(in.read_string())";
+      }
+      else {
+        ofs_ << "in.read<" << fld->type() << ">()";
+      }
+      ofs_ << ");" << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_load_stats() {
+
+    if (component_->load_mode() != "pipelined") {
+      return;
+    }
+    ofs_ << "  //////" << std::endl
+         << "  /// last load stats" << std::endl
+         << "  //////" << std::endl
+         << "  inline framework::load_stats" << std::endl
+         << "  " << component_->class_name() << "_mapping::" << std::endl
+         << "  last_load_stats() {" << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+         << "    return load_stats_;" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_build(const std::string& rows) {
+
+    std::string class_name = component_->class_name();
+    if (! component_->version().empty()) {
+      field::ptr ver = component_->get_field(component_->version());
+      ofs_ << "    " << ver->type() << " mark = 0;" << std::endl;
+    }
+    bool bulk = component_->has_bulk_load();
+    std::string expected = "loaded_rows_";
+    if (component_->expected_rows() > 0) {
+      expected = "std::max<std::size_t>(" + std::to_string(component_->expected_rows())
+               + ", loaded_rows_)";
+    }
+    if (bulk && component_->concurrency() == "sharded") {
+      ofs_ << "    std::vector<std::vector<" << element_type() << ">> rows(shard_count);"
+           << std::endl
+           << "    for (auto& shard_rows : rows) {" << std::endl
+           << "      shard_rows.reserve(" << expected << " / shard_count);" << std::endl
+           << "    }" << std::endl;
+    }
+    else if (bulk) {
+      ofs_ << "    std::vector<" << element_type() << "> rows;" << std::endl
+           << "    rows.reserve(" << expected << ");" << std::endl;
+    }
+
+    if (component_->layout() != "rows") {
+      if (component_->layout() == "mapped") {
+        ofs_ << "    std::vector<" << class_name << "> rows;" << std::endl;
+        implement_fetch_loop("rows.push_back(area);", rows);
+        ofs_ << "    auto next = " << class_name << "_table::build(std::move(rows));"
+             << std::endl;
+      }
+      else {
+        ofs_ << "    auto table = std::make_shared<" << class_name << "_table>();"
+             << std::endl;
+        implement_fetch_loop("table->columns.push_back(area);", rows);
+        ofs_ << "    table->build();" << std::endl
+             << "    std::shared_ptr<const " << class_name << "_table> next(std::move(table));"
+             << std::endl;
+      }
+      if (component_->concurrency() == "snapshot") {
+        ofs_ << "    std::atomic_store(&" << class_name << "_table_, next);" << std::endl;
+      }
+      else {
+        ofs_ << "    " << class_name << "_table_ = next;" << std::endl;
+      }
+      implement_build_end(rows);
+      ofs_ << "    return true;" << std::endl
+           << "  }" << std::endl << std::endl;
+      return;
+    }
+
+    if (component_->concurrency() == "sharded") {
+      index::ptr ndx = component_->unique_index();
+      ofs_ << "    std::vector<" << class_name << "_table> tables(shard_count);"
+           << std::endl;
+      std::string shard = "shard_of(" + key_arguments(ndx, "row->", "()", ", ") + ")";
+      if (bulk) {
+        implement_fetch_loop("rows[" + shard + "].push_back(std::move(row));", rows);
+        ofs_ << "    loaded_rows_ = 0;" << std::endl
+             << "    for (std::size_t i = 0; i < shard_count; ++i) {" << std::endl
+             << "      framework::bulk_insert(tables[i], rows[i]);" << std::endl
+             << "      loaded_rows_ += rows[i].size();" << std::endl
+             << "    }" << std::endl;
+      }
+      else {
+        implement_fetch_loop("tables[" + shard + "].insert(row);", rows);
+      }
+      ofs_ << "    for (std::size_t i = 0; i < shard_count; ++i) {" << std::endl
+           << "      std::lock_guard<std::mutex>  shard_guard(shards_[i].lock_);"
+           << std::endl
+           << "      shards_[i].table_.swap(tables[i]);" << std::endl
+           << "    }" << std::endl;
+      implement_build_end(rows);
+      ofs_ << "    return true;" << std::endl
+           << "  }" << std::endl << std::endl;
+      return;
+    }
+    if (component_->allocation() == "arena") {
+      std::string generation = class_name + "_generation";
+      ofs_ << "    auto generation = std::make_shared<" << generation << ">();"
+           << std::endl
+           << "    auto& table = generation->table;" << std::endl;
+      if (bulk) {
+        implement_fetch_loop("rows.push_back(std::move(row));", rows);
+        ofs_ << "    framework::bulk_insert(table, rows, [](" << element_type()
+             << " row) { row->~" << class_name << "(); });" << std::endl
+             << "    loaded_rows_ = rows.size();" << std::endl;
+      }
+      else {
+        implement_fetch_loop("if (! table.insert(row)) row->~" + class_name + "();", rows);
+      }
+      if (component_->has_flat_indices()) {
+        ofs_ << "    table.build();" << std::endl;
+      }
+      ofs_ << "    std::shared_ptr<const " << generation << "> next(std::move(generation));"
+           << std::endl;
+      if (component_->raw_finders()) {
+        implement_raw_publish(generation + "_");
+      }
+      else if (component_->concurrency() == "snapshot") {
+        ofs_ << "    std::atomic_store(&" << generation << "_, next);" << std::endl;
+      }
+      else {
+        ofs_ << "    " << generation << "_ = next;" << std::endl;
+      }
+      implement_build_end(rows);
+      ofs_ << "    return true;" << std::endl
+           << "  }" << std::endl << std::endl;
+      return;
+    }
+    {
+      ofs_ << "    auto table = std::make_shared<" << class_name << "_table>();"
+           << std::endl;
+      if (bulk) {
+        implement_fetch_loop("rows.push_back(std::move(row));", rows);
+        ofs_ << "    framework::bulk_insert(*table, rows);" << std::endl
+             << "    loaded_rows_ = rows.size();" << std::endl;
+      }
+      else {
+        implement_fetch_loop("table->insert(row);", rows);
+      }
+      if (component_->has_flat_indices()) {
+        ofs_ << "    table->build();" << std::endl;
+      }
+      if (component_->concurrency() == "mutex") {
+        ofs_ << "    " << class_name << "_table_ = std::move(table);" << std::endl;
+      }
+      else {
+        ofs_ << "    std::shared_ptr<const " << class_name << "_table> next(std::move(table));"
+             << std::endl;
+        if (component_->raw_finders()) {
+          implement_raw_publish(class_name + "_table_");
+        }
+        else {
+          ofs_ << "    std::atomic_store(&" << class_name << "_table_, next);" << std::endl;
+        }
+      }
+      implement_build_end(rows);
+      ofs_ << "    return true;" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_build_end(const std::string& rows) {
+
+    implement_mark_store();
+    if (rows == "pipeline") {
+      ofs_ << "    stats.build = std::chrono::steady_clock::now() - start;" << std::endl
+           << "    stats.fetch_blocked = ring.push_blocked();" << std::endl
+           << "    stats.build_blocked = ring.pop_blocked();" << std::endl
+           << "    load_stats_ = stats;" << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_mark_store() {
+
+    if (! component_->version().empty()) {
+      ofs_ << "    high_water_mark_ = mark;" << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_delta() {
+
+    if (component_->version().empty()) {
+      return;
+    }
     std::string class_name = component_->class_name();
-    ofs_ << "    //////" << std::endl
-         << "    /// finder methods" << std::endl
-         << "    //////" << std::endl;
+    std::string mapping = class_name + "_mapping";
+    field::ptr ver = component_->get_field(component_->version());
+    index::ptr ndx = component_->unique_index();
+    std::string key = key_arguments(ndx, "area.", "()", ", ");
+    bool sharded = component_->concurrency() == "sharded";
+    bool snapshot = component_->concurrency() == "snapshot";
+    auto sp = component_->get_stored_procs().find("delta")->second;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// delta load" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  apply_delta(connection_ptr conn) {" << std::endl << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+         << "    std::string sp = \"exec " << sp->name()
+         << " \" + std::to_string(high_water_mark_);" << std::endl
+         << "    " << class_name << " area;" << std::endl
+         << "    int result = conn->execute(sp);" << std::endl
+         << "    if (result == FAIL) return false;" << std::endl << std::endl
+         << "    " << ver->type() << " mark = high_water_mark_;" << std::endl;
+    if (snapshot) {
+      ofs_ << "    // readers keep the published table, the delta copies all of it"
+           << std::endl
+           << "    auto table = std::make_shared<" << class_name << "_table>(*"
+           << class_name << "_table_);" << std::endl
+           << "    auto& p = table->get<" << ndx->alias() << "_tag>();" << std::endl;
+    }
+    else if (! sharded) {
+      ofs_ << "    // a range still reading the table keeps it, the delta goes into a copy"
+           << std::endl
+           << "    if (" << class_name << "_table_.use_count() > 1) {" << std::endl
+           << "      " << class_name << "_table_ = std::make_shared<" << class_name
+           << "_table>(*" << class_name << "_table_);" << std::endl
+           << "    }" << std::endl
+           << "    // otherwise the last range to let go was done reading it" << std::endl
+           << "    else {" << std::endl
+           << "      std::atomic_thread_fence(std::memory_order_acquire);" << std::endl
+           << "    }" << std::endl
+           << "    auto& p = " << class_name << "_table_->get<" << ndx->alias()
+           << "_tag>();" << std::endl;
+    }
+    ofs_ << "    std::size_t rejected = 0;" << std::endl
+         << "    area.bind(conn);" << std::endl
+         << "    while (conn->nextRow() != NO_MORE_ROWS) {" << std::endl;
+    if (component_->has_fetch_buffers()) {
+      ofs_ << "      area.fetched();" << std::endl;
+    }
+    std::string v = "area." + ver->name() + "()";
+    ofs_ << "      if (" << v << " > mark) mark = " << v << ";" << std::endl;
+    if (sharded) {
+      if (! component_->deleted().empty()) {
+        ofs_ << "      if (area." << component_->deleted() << "()) {" << std::endl
+             << "        erase_by_" << ndx->alias() << "(" << key << ");" << std::endl
+             << "        continue;" << std::endl
+             << "      }" << std::endl;
+      }
+      ofs_ << "      if (! upsert(std::make_shared<" << class_name << ">(area))) ++rejected;"
+           << std::endl
+           << "    }" << std::endl;
+    }
+    else {
+      std::string lookup;
+      for (const auto& k : ndx->get_index_pairs()) {
+        lookup += (lookup.empty() ? "area." : ", area.") + key_member(k) + "()";
+      }
+      if (ndx->get_index_pairs().size() > 1) {
+        lookup = "boost::make_tuple(" + lookup + ")";
+      }
+      ofs_ << "      auto q = p.find(" << lookup << ");" << std::endl;
+      if (! component_->deleted().empty()) {
+        ofs_ << "      if (area." << component_->deleted() << "()) {" << std::endl
+             << "        if (q != p.end()) p.erase(q);" << std::endl
+             << "        continue;" << std::endl
+             << "      }" << std::endl;
+      }
+      ofs_ << "      " << class_name << "::ptr row = std::make_shared<"
+           << class_name << ">(area);" << std::endl
+           << "      bool applied = q == p.end() ? p.insert(row).second : p.replace(q, row);"
+           << std::endl
+           << "      if (! applied) ++rejected;" << std::endl
+           << "    }" << std::endl;
+    }
+    if (snapshot) {
+      ofs_ << "    std::shared_ptr<const " << class_name << "_table> next(std::move(table));"
+           << std::endl;
+      if (component_->raw_finders()) {
+        implement_raw_publish(class_name + "_table_");
+      }
+      else {
+        ofs_ << "    std::atomic_store(&" << class_name << "_table_, next);" << std::endl;
+      }
+    }
+    implement_mark_store();
+    ofs_ << "    return rejected == 0;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// high water mark" << std::endl
+         << "  //////" << std::endl
+         << "  inline " << ver->type() << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  high_water_mark() {" << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+         << "    return high_water_mark_;" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_write_behind() {
+
+    if (! component_->has_writer()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    std::string writer = "framework::write_behind<" + class_name + "::ptr>";
+    auto sp = component_->get_stored_procs().find("insert")->second;
+    ofs_ << "  //////" << std::endl
+         << "  /// write behind" << std::endl
+         << "  //////" << std::endl << std::endl
+         << "  inline void" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  start_writer(std::function<connection_ptr()> connect," << std::endl
+         << "               std::size_t batch_size," << std::endl
+         << "               std::chrono::milliseconds linger) {" << std::endl << std::endl
+         << "    auto flush = [connect](const " << class_name << "::ptr* rows, "
+         << "std::size_t count) {" << std::endl
+         << "      connection_ptr conn = connect();" << std::endl
+         << "      return conn && insert_rows(conn, rows, count);" << std::endl
+         << "    };" << std::endl
+         << "    auto next = std::make_shared<" << writer << ">(batch_size, linger, flush);"
+         << std::endl
+         << "    // the prior writer flushes its queue as it goes out of scope" << std::endl
+         << "    auto prior = std::atomic_exchange(&writer_, next);" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  inline void" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  stop_writer() {" << std::endl
+         << "    // flushes the queue unless a save still holds the writer" << std::endl
+         << "    auto prior = std::atomic_exchange(&writer_, std::shared_ptr<"
+         << writer << ">());" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    std::string params[] = {
+      "const " + class_name + "::ptr& row",
+      "std::vector<" + class_name + "::ptr> rows"
+    };
+    std::string names[] = { "save", "save_batch" };
+    std::string args[] = { "row", "std::move(rows)" };
+    for (size_t i = 0; i < 2; ++i) {
+      ofs_ << "  inline std::future<bool>" << std::endl
+           << "  " << mapping << "::" << std::endl
+           << "  " << names[i] << "(" << params[i] << ") {" << std::endl << std::endl
+           << "    auto writer = std::atomic_load(&writer_);" << std::endl
+           << "    if (! writer) {" << std::endl
+           << "      std::promise<bool> rejected;" << std::endl
+           << "      rejected.set_value(false);" << std::endl
+           << "      return rejected.get_future();" << std::endl
+           << "    }" << std::endl
+           << "    return writer->push(" << args[i] << ");" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+
+    ofs_ << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  insert_rows(connection_ptr conn," << std::endl
+         << "              const " << class_name << "::ptr* rows," << std::endl
+         << "              std::size_t count) {" << std::endl << std::endl
+         << "    std::string sp;" << std::endl
+         << "    for (std::size_t i = 0; i < count; ++i) {" << std::endl
+         << "      const " << class_name << "& row = *rows[i];" << std::endl
+         << "      sp += \"exec " << sp->name() << " \";" << std::endl;
+    const auto& flds = component_->get_fields();
+    for (size_t i = 0; i < flds.size(); ++i) {
+      ofs_ << "      sp += framework::sql_literal(row." << flds[i]->name() << "());"
+           << std::endl;
+      ofs_ << "      sp += \"" << (i + 1 < flds.size() ? ", " : "\\n") << "\";"
+           << std::endl;
+    }
+    ofs_ << "    }" << std::endl
+         << "    return conn->execute(sp) != FAIL;" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_refresh() {
+
+    if (! component_->has_refresh()) {
+      return;
+    }
+    std::string mapping = component_->class_name() + "_mapping";
+    auto sp = component_->get_stored_procs().find("fingerprint")->second;
+    std::string reload = component_->version().empty() ? "load_rows" : "apply_delta";
+    std::string now = "std::chrono::steady_clock::now().time_since_epoch().count()";
+    ofs_ << "  //////" << std::endl
+         << "  /// fingerprint, the proc returns one row of row_count and checksum,"
+         << std::endl
+         << "  /// any further rows are drained so the connection can run the next"
+         << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  read_fingerprint(connection_ptr conn, int& rows, std::string& checksum) {"
+         << std::endl << std::endl
+         << "    std::string sp = \"exec " << sp->name() << "\";" << std::endl
+         << "    int count = 0;" << std::endl
+         << "    std::string sum(64, '\\0');" << std::endl
+         << "    int result = conn->execute(sp);" << std::endl
+         << "    if (result == FAIL) return false;" << std::endl << std::endl
+         << "    conn->genericBind(\"row_count\", count);" << std::endl
+         << "    conn->genericBind(\"checksum\", &sum[0]);" << std::endl
+         << "    if (conn->nextRow() == NO_MORE_ROWS) return false;" << std::endl
+         << "    rows = count;" << std::endl
+         << "    checksum = sum;" << std::endl
+         << "    while (conn->nextRow() != NO_MORE_ROWS) {" << std::endl
+         << "    }" << std::endl
+         << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// load, a failed fingerprint leaves none kept and the next refresh"
+         << std::endl
+         << "  /// reloads" << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  load(connection_ptr conn) {" << std::endl << std::endl
+         << "    std::lock_guard<std::mutex>  guard(refresh_lock_);" << std::endl
+         << "    int rows = 0;" << std::endl
+         << "    std::string checksum;" << std::endl
+         << "    bool fingerprinted = read_fingerprint(conn, rows, checksum);" << std::endl
+         << "    if (! load_rows(conn)) return false;" << std::endl
+         << "    fingerprint_rows_ = fingerprinted ? rows : -1;" << std::endl
+         << "    fingerprint_checksum_ = checksum;" << std::endl
+         << "    if (fingerprinted) {" << std::endl
+         << "      verified_.store(" << now << ");" << std::endl
+         << "    }" << std::endl
+         << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// refresh, any change in row_count or checksum triggers the reload"
+         << std::endl
+         << "  //////" << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  refresh(connection_ptr conn) {" << std::endl << std::endl
+         << "    std::lock_guard<std::mutex>  guard(refresh_lock_);" << std::endl
+         << "    int rows = 0;" << std::endl
+         << "    std::string checksum;" << std::endl
+         << "    if (! read_fingerprint(conn, rows, checksum)) return false;" << std::endl
+         << "    if (rows != fingerprint_rows_ || checksum != fingerprint_checksum_) {"
+         << std::endl
+         << "      if (! " << reload << "(conn)) return false;" << std::endl
+         << "      fingerprint_rows_ = rows;" << std::endl
+         << "      fingerprint_checksum_ = checksum;" << std::endl
+         << "    }" << std::endl
+         << "    verified_.store(" << now << ");" << std::endl
+         << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// background refresher" << std::endl
+         << "  //////" << std::endl << std::endl
+         << "  inline void" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  start_refresher(std::function<connection_ptr()> connect," << std::endl
+         << "                  std::chrono::milliseconds period," << std::endl
+         << "                  std::chrono::milliseconds jitter) {" << std::endl << std::endl
+         << "    auto task = [this, connect] {" << std::endl
+         << "      connection_ptr conn = connect();" << std::endl
+         << "      if (conn) refresh(conn);" << std::endl
+         << "    };" << std::endl
+         << "    auto next = std::make_unique<framework::periodic_refresher>(period, jitter, task);"
+         << std::endl
+         << "    {" << std::endl
+         << "      std::lock_guard<std::mutex>  guard(refresh_lock_);" << std::endl
+         << "      refresher_.swap(next);" << std::endl
+         << "    }" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  inline void" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  stop_refresher() {" << std::endl << std::endl
+         << "    std::unique_ptr<framework::periodic_refresher> stopping;" << std::endl
+         << "    {" << std::endl
+         << "      std::lock_guard<std::mutex>  guard(refresh_lock_);" << std::endl
+         << "      stopping.swap(refresher_);" << std::endl
+         << "    }" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  //////" << std::endl
+         << "  /// staleness" << std::endl
+         << "  //////" << std::endl
+         << "  inline std::chrono::steady_clock::duration" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  staleness() const {" << std::endl
+         << "    std::chrono::steady_clock::duration since(verified_.load());" << std::endl
+         << "    if (since.count() == 0) {" << std::endl
+         << "      return std::chrono::steady_clock::duration::max();" << std::endl
+         << "    }" << std::endl
+         << "    return std::chrono::steady_clock::now().time_since_epoch() - since;"
+         << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_fetch_loop(const std::string& insert, const std::string& rows) {
+
+    std::string class_name = component_->class_name();
+    std::string indent = "      ";
+    std::string source = "area";
+    if (rows == "partitions") {
+      ofs_ << "    for (auto& part : fetched) {" << std::endl
+           << "      for (auto& area : part) {" << std::endl;
+      indent = "        ";
+      source = "std::move(area)";
+    }
+    else if (rows == "snapshot") {
+      ofs_ << "    for (std::uint64_t i = 0; i < in.rows() && ! in.overrun(); ++i) {"
+           << std::endl;
+      implement_snapshot_read(indent);
+    }
+    else if (rows == "pipeline") {
+      ofs_ << "    std::vector<" << class_name << "> part;" << std::endl
+           << "    while (ring.pop(part)) {" << std::endl
+           << "      for (auto& area : part) {" << std::endl;
+      indent = "        ";
+      source = "std::move(area)";
+    }
+    else {
+      ofs_ << "    area.bind(conn);" << std::endl
+           << "    while (conn->nextRow() != NO_MORE_ROWS) {" << std::endl;
+      if (component_->has_fetch_buffers()) {
+        ofs_ << indent << "area.fetched();" << std::endl;
+      }
+    }
+    if (! component_->version().empty()) {
+      std::string ver = "area." + component_->version() + "()";
+      ofs_ << indent << "if (" << ver << " > mark) mark = " << ver << ";" << std::endl;
+    }
+    if (component_->allocation() == "arena") {
+      ofs_ << indent << element_type() << " row = new (generation->arena.allocate("
+           << std::endl
+           << indent << "  sizeof(" << class_name << "), alignof(" << class_name
+           << "))) " << class_name << "(" << source << ");" << std::endl;
+    }
+    else if (component_->layout() == "rows") {
+      ofs_ << indent << class_name << "::ptr row = std::make_shared<"
+           << class_name << ">(" << source << ");" << std::endl;
+    }
+    ofs_ << indent << insert << std::endl;
+    if (rows == "partitions" || rows == "pipeline") {
+      ofs_ << "      }" << std::endl;
+    }
+    ofs_ << "    }" << std::endl;
+    if (rows == "snapshot") {
+      ofs_ << "    if (! in.complete()) {" << std::endl;
+      if (component_->allocation() == "arena" && component_->has_bulk_load()) {
+        ofs_ << "      for (" << element_type() << " row : rows) row->~" << class_name
+             << "();" << std::endl;
+      }
+      ofs_ << "      return false;" << std::endl
+           << "    }" << std::endl;
+    }
+    if (rows == "pipeline") {
+      ofs_ << "    fetcher.join();" << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_load_partitioned() {
+
+    stored_proc::parameter part = component_->partition_parameter();
+    if (part.first.empty()) {
+      return;
+    }
+    std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
+    auto sp = component_->get_stored_procs().find("read")->second;
+    ofs_ << "  //////" << std::endl
+         << "  /// partitioned load" << std::endl
+         << "  //////" << std::endl << std::endl
+         << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  fetch_partition(connection_ptr conn," << std::endl
+         << "                  const " << part.second << "& partition," << std::endl
+         << "                  std::vector<" << class_name << ">& rows) {" << std::endl
+         << std::endl
+         << "    if (! conn) return false;" << std::endl
+         << "    std::string sp = \"exec " << sp->name()
+         << " \" + framework::sql_literal(partition);" << std::endl
+         << "    " << class_name << " area;" << std::endl
+         << "    int result = conn->execute(sp);" << std::endl
+         << "    if (result == FAIL) return false;" << std::endl << std::endl
+         << "    area.bind(conn);" << std::endl
+         << "    while (conn->nextRow() != NO_MORE_ROWS) {" << std::endl;
+    if (component_->has_fetch_buffers()) {
+      ofs_ << "      area.fetched();" << std::endl;
+    }
+    ofs_ << "      rows.push_back(area);" << std::endl
+         << "    }" << std::endl
+         << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl;
+
+    ofs_ << "  inline bool" << std::endl
+         << "  " << mapping << "::" << std::endl
+         << "  load_partitioned(const std::vector<" << part.second << ">& partitions,"
+         << std::endl
+         << "                   std::function<connection_ptr()> connect) {" << std::endl
+         << std::endl
+         << "    std::vector<std::vector<" << class_name
+         << ">> fetched(partitions.size());" << std::endl
+         << "    std::vector<std::future<bool>> fetches;" << std::endl
+         << "    for (std::size_t i = 0; i < partitions.size(); ++i) {" << std::endl
+         << "      fetches.push_back(std::async(std::launch::async, [&, i] {" << std::endl
+         << "        return fetch_partition(connect(), partitions[i], fetched[i]);"
+         << std::endl
+         << "      }));" << std::endl
+         << "    }" << std::endl
+         << "    bool complete = true;" << std::endl
+         << "    for (auto& f : fetches) {" << std::endl
+         << "      complete = f.get() && complete;" << std::endl
+         << "    }" << std::endl
+         << "    if (! complete) return false;" << std::endl << std::endl
+         << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl;
+    implement_build("partitions");
+  }
+
+  inline void
+  mapping_maker::
+  implement_writers() {
+
+    implement_write_behind();
+    if (component_->concurrency() != "sharded") {
+      return;
+    }
+    std::string class_name = component_->class_name() + "_mapping";
+    std::string row_class = component_->class_name();
+    index::ptr ndx = component_->unique_index();
+    std::string row_key = key_arguments(ndx, "row->", "()", ", ");
+    ofs_ << "  //////" << std::endl
+         << "  /// point writers" << std::endl
+         << "  //////" << std::endl << std::endl
+         << "  inline bool" << std::endl
+         << "  " << class_name << "::" << std::endl
+         << "  upsert(const " << row_class << "::ptr& row) {" << std::endl << std::endl
+         << "    auto& s = shards_[shard_of(" << row_key << ")];" << std::endl
+         << "    std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+         << "    auto& p = s.table_.get<" << ndx->alias() << "_tag>();" << std::endl
+         << "    auto q = p.find(p.key_extractor()(row));" << std::endl
+         << "    if (q == p.end()) {" << std::endl
+         << "      return p.insert(row).second;" << std::endl
+         << "    }" << std::endl
+         << "    return p.replace(q, row);" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  inline bool" << std::endl
+         << "  " << class_name << "::" << std::endl;
+    declare_key_parameters("  erase_by_" + ndx->alias() + "(", ndx, ") {");
+    ofs_ << std::endl
+         << "    auto& s = shards_[shard_of(" << key_arguments(ndx, "", "", ", ")
+         << ")];" << std::endl
+         << "    std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+         << "    auto& p = s.table_.get<" << ndx->alias() << "_tag>();" << std::endl
+         << "    auto q = p.find(" << key_lookup(ndx) << ");" << std::endl
+         << "    if (q == p.end()) return false;" << std::endl
+         << "    p.erase(q);" << std::endl
+         << "    return true;" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_finders() {
+
+    std::string class_name = component_->class_name() + "_mapping";
+    std::string row_class = component_->class_name();
+    ofs_ << "  //////" << std::endl
+         << "  /// finders" << std::endl
+         << "  //////" << std::endl << std::endl;
 
+    index::ptr shard_key = component_->unique_index();
     auto p = component_->get_indices().begin();
     auto q = component_->get_indices().end();
     for (; p != q; ++p) {
+
       index::ptr ndx = *p;
-      std::string line = "    " + class_name + "::ptr find_by_" + ndx->alias() + "(";
-      size_t len = line.size();
-      ofs_ << line;
-
-      auto a = ndx->get_index_pairs().begin();
-      auto b = ndx->get_index_pairs().end();
-      size_t i = 0;
-      size_t n = std::distance(a, b);
-      for (; a != b; ++a, ++i) {
-
-        std::string index_name = a->first;
-        std::string index_type = a->second;       
-        if (i != 0) {
-          ofs_ << std::string(len, ' ');
-        }
-        if (index_type == "std::string") {
-          ofs_ << "const std::string& ";
+      std::string alias = ndx->alias();
+      ofs_ << "  inline " << result_type() << " " << std::endl
+           << "  " << class_name << "::" << std::endl;
+      declare_key_parameters("  find_by_" + alias + "(", ndx, ") {");
+      ofs_ << std::endl;
+
+      if (component_->layout() != "rows") {
+        std::string key = row_class + "_table::" + alias + "_key";
+        std::string of = alias + "_of";
+        bool eytzinger = ndx->type() == "eytzinger";
+        ofs_ << "    auto table = current();" << std::endl
+             << "    const auto& ids = table->" << alias << "_ids;" << std::endl
+             << "    " << key << " key("
+             << key_arguments(ndx, "", "", ", ") << ");" << std::endl
+             << "    auto below = [&table, &key](std::uint32_t row) {" << std::endl
+             << "      return table->" << of << "(row) < key;" << std::endl
+             << "    };" << std::endl
+             << "    std::size_t q = framework::"
+             << (eytzinger ? "eytzinger_lower_bound" : "branchless_lower_bound")
+             << "(ids, below);" << std::endl
+             << "    if (q == " << (eytzinger ? "0" : "ids.size()")
+             << " || table->" << of << "(ids[q]) != key) {" << std::endl
+             << "      return " << result_type() << "();" << std::endl
+             << "    }" << std::endl;
+        if (component_->layout() == "mapped") {
+          ofs_ << "    return " << result_type() << "(table, &table->rows[ids[q]]);"
+               << std::endl;
         }
         else {
-          ofs_ << index_type << " ";
+          ofs_ << "    return " << result_type() << "(std::shared_ptr<const "
+               << row_class << "_columns>(table, &table->columns), ids[q]);" << std::endl;
+        }
+        ofs_ << "  }" << std::endl << std::endl;
+        continue;
+      }
+
+      std::string lookup = key_lookup(ndx);
+      if (component_->concurrency() == "sharded") {
+        if (ndx == shard_key) {
+          ofs_ << "    auto& s = shards_[shard_of("
+               << key_arguments(ndx, "", "", ", ") << ")];" << std::endl
+               << "    std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+               << "    const auto& p = s.table_.get<" << alias << "_tag>();" << std::endl
+               << "    auto q = p.find(" << lookup << ");" << std::endl
+               << "    return q != p.end() ? *q : " << row_class << "::ptr();" << std::endl
+               << "  }" << std::endl << std::endl;
+          continue;
+        }
+        ofs_ << "    for (auto& s : shards_) {" << std::endl
+             << "      std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+             << "      const auto& p = s.table_.get<" << alias << "_tag>();" << std::endl
+             << "      auto q = p.find(" << lookup << ");" << std::endl
+             << "      if (q != p.end()) return *q;" << std::endl
+             << "    }" << std::endl
+             << "    return " << row_class << "::ptr();" << std::endl
+             << "  }" << std::endl << std::endl;
+        continue;
+      }
+      if (ndx->is_flat()) {
+        std::string table = row_class + "_table";
+        if (component_->allocation() == "arena") {
+          ofs_ << "    auto generation = current();" << std::endl
+               << "    const auto& rows = generation->table.rows;" << std::endl
+               << "    const auto& ids = generation->table." << alias << "_ids;" << std::endl;
         }
-        ofs_ << index_name;
-        if (i < n - 1) {
-          ofs_ << ",";
+        else if (component_->concurrency() == "snapshot") {
+          ofs_ << "    auto table = std::atomic_load(&" << table << "_);" << std::endl
+               << "    const auto& rows = table->rows;" << std::endl
+               << "    const auto& ids = table->" << alias << "_ids;" << std::endl;
         }
         else {
-          ofs_ << ");";
+          ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+               << "    const auto& rows = " << table << "_->rows;" << std::endl
+               << "    const auto& ids = " << table << "_->" << alias << "_ids;" << std::endl;
         }
-        ofs_ << std::endl;
+        implement_flat_lookup(ndx, hold("rows[ids[q]]"), row_class + "::ptr()");
+        continue;
+      }
+      if (component_->allocation() == "arena") {
+        ofs_ << "    auto generation = current();" << std::endl
+             << "    const auto& p = generation->table.get<"
+             << alias << "_tag>();" << std::endl;
+      }
+      else if (component_->concurrency() == "snapshot") {
+        ofs_ << "    auto table = std::atomic_load(&"
+             << row_class << "_table_);"
+             << std::endl;
+        ofs_ << "    const auto& p = table->get<"
+             << alias << "_tag>();"
+             << std::endl;
+      }
+      else {
+        ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);"
+             << std::endl;
+        ofs_ << "    const auto& p = "
+             << row_class + "_table_->get<"
+             << alias << "_tag>();"
+             << std::endl;
       }
+      ofs_ << "    auto q = p.find(" << lookup << ");" << std::endl;
+      ofs_ << "    return q != p.end() ? " << hold("*q") << " : "
+           << row_class
+           << "::ptr();"
+           << std::endl
+           << "  }"
+           << std::endl << std::endl;
     }
-    ofs_ << std::endl;
   }
 
   inline void
   mapping_maker::
-  declare_members() {
+  implement_flat_lookup(index::ptr ndx,
+                        const std::string& found,
+                        const std::string& none) {
+
+    std::string table = component_->class_name() + "_table";
+    std::string alias = ndx->alias();
+    std::string of = table + "::" + alias + "_of";
+    bool eytzinger = ndx->type() == "eytzinger";
+    ofs_ << "    " << table << "::" << alias << "_key key("
+         << key_arguments(ndx, "", "", ", ") << ");" << std::endl
+         << "    auto below = [&rows, &key](std::uint32_t row) {" << std::endl
+         << "      return " << of << "(rows[row]) < key;" << std::endl
+         << "    };" << std::endl
+         << "    std::size_t q = framework::"
+         << (eytzinger ? "eytzinger_lower_bound" : "branchless_lower_bound")
+         << "(ids, below);" << std::endl
+         << "    if (q == " << (eytzinger ? "0" : "ids.size()")
+         << " || " << of << "(rows[ids[q]]) != key) {" << std::endl
+         << "      return " << none << ";" << std::endl
+         << "    }" << std::endl
+         << "    return " << found << ";" << std::endl
+         << "  }" << std::endl << std::endl;
+  }
+
+  inline void
+  mapping_maker::
+  implement_raw_publish(const std::string& owner) {
 
     std::string class_name = component_->class_name();
-    ofs_ << "  private:" << std::endl << std::endl
-         << "    //////" << std::endl
-         << "    /// default constructor" << std::endl
-         << "    //////" << std::endl
-         << "    " << class_name << "_mapping"
-         << "();" << std::endl << std::endl;
+    ofs_ << "    auto prior = std::atomic_exchange(&" << owner << ", next);" << std::endl
+         << "    " << class_name << "_current_.store(next.get());" << std::endl
+         << "    framework::epoch_domain::instance().retire(std::move(prior));"
+         << std::endl;
+  }
 
-    ofs_ << "    //////" << std::endl
-         << "    /// boost multi-index tag definitions" << std::endl
-         << "    //////" << std::endl;
+  inline void
+  mapping_maker::
+  implement_raw_finders() {
 
-    auto a = component_->get_indices().begin();
-    auto b = component_->get_indices().end();
-    for (; a != b; ++a) {
-      index::ptr ndx = *a;
-      ofs_ << "    struct " << ndx->alias() << "_tag {};" << std::endl;
+    if (! component_->raw_finders()) {
+      return;
     }
-    ofs_ << std::endl;
-    ofs_ << "    //////" << std::endl
-         << "    /// boost multi-index definition" << std::endl
-         << "    //////" << std::endl;
-    ofs_ << "    typedef mti::multi_index_container<" << std::endl
-         << "      " << class_name << "::ptr," << std::endl
-         << "      mti::indexed_by<" << std::endl;
+    std::string class_name = component_->class_name() + "_mapping";
+    std::string row_class = component_->class_name();
+    bool arena = component_->allocation() == "arena";
+    std::string table = arena ? row_class + "_current_.load()->table"
+                              : "*" + row_class + "_current_.load()";
+    std::string raw = arena ? "" : ".get()";
+    ofs_ << "  //////" << std::endl
+         << "  /// raw finders" << std::endl
+         << "  //////" << std::endl << std::endl;
 
-    a = component_->get_indices().begin();
-    b = component_->get_indices().end();
-    size_t n = std::distance(a, b);
-    for (size_t i = 0; a != b; ++a, ++i) {
+    for (auto ndx : component_->get_indices()) {
+
+      std::string alias = ndx->alias();
+      ofs_ << "  inline const " << row_class << "*" << std::endl
+           << "  " << class_name << "::" << std::endl;
+      declare_key_parameters("  find_by_" + alias + "_raw(", ndx, ") {");
+      ofs_ << std::endl
+           << "    const auto& table = " << table << ";" << std::endl;
+      if (ndx->is_flat()) {
+        ofs_ << "    const auto& rows = table.rows;" << std::endl
+             << "    const auto& ids = table." << alias << "_ids;" << std::endl;
+        implement_flat_lookup(ndx, "rows[ids[q]]" + raw, "nullptr");
+        continue;
+      }
+      ofs_ << "    const auto& p = table.get<" << alias << "_tag>();" << std::endl
+           << "    auto q = p.find(" << key_lookup(ndx) << ");" << std::endl
+           << "    return q != p.end() ? " << (arena ? "*q" : "q->get()")
+           << " : nullptr;" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_table_access() {
+
+    std::string class_name = component_->class_name();
+    if (component_->allocation() == "arena") {
+      ofs_ << "    auto generation = current();" << std::endl
+           << "    const auto& table = generation->table;" << std::endl;
+    }
+    else if (component_->concurrency() == "snapshot") {
+      ofs_ << "    auto snapshot = std::atomic_load(&" << class_name << "_table_);"
+           << std::endl
+           << "    const auto& table = *snapshot;" << std::endl;
+    }
+    else {
+      ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+           << "    const auto& table = *" << class_name << "_table_;" << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_batch_finders() {
+
+    if (! component_->batch_finders()) {
+      return;
+    }
+    std::string class_name = component_->class_name() + "_mapping";
+    std::string row_class = component_->class_name();
+    std::string none = result_type() + "()";
+    ofs_ << "  //////" << std::endl
+         << "  /// batch finders" << std::endl
+         << "  //////" << std::endl << std::endl;
+
+    for (auto ndx : component_->get_indices()) {
+
+      std::string alias = ndx->alias();
+      std::string lead = "  find_by_" + alias + "_batch(";
+      std::string indent(lead.size(), ' ');
+      ofs_ << "  inline void" << std::endl
+           << "  " << class_name << "::" << std::endl
+           << lead << "const " << alias << "_key* keys," << std::endl
+           << indent << "std::size_t count," << std::endl
+           << indent << result_type() << "* out) {" << std::endl << std::endl;
+
+      if (component_->layout() != "rows") {
+        std::string table = row_class + "_table";
+        bool eytzinger = ndx->type() == "eytzinger";
+        bool mapped = component_->layout() == "mapped";
+        ofs_ << "    std::vector<" << table << "::" << alias
+             << "_key> probe(keys, keys + count);" << std::endl
+             << "    std::vector<std::size_t> found(count);" << std::endl
+             << "    auto table = current();" << std::endl;
+        if (! mapped) {
+          ofs_ << "    std::shared_ptr<const " << row_class << "_columns> columns(table, &table->columns);"
+               << std::endl;
+        }
+        ofs_ << "    const auto& ids = table->" << alias << "_ids;" << std::endl
+             << "    auto below = [&table, &probe](std::size_t i, std::uint32_t row) {"
+             << std::endl
+             << "      return table->" << alias << "_of(row) < probe[i];" << std::endl
+             << "    };" << std::endl
+             << "    framework::"
+             << (eytzinger ? "eytzinger_lower_bound_batch" : "branchless_lower_bound_batch")
+             << "(ids, count, below, found.data());" << std::endl
+             << "    for (std::size_t i = 0; i < count; ++i) {" << std::endl
+             << "      std::size_t q = found[i];" << std::endl
+             << "      out[i] = q == " << (eytzinger ? "0" : "ids.size()")
+             << " || table->" << alias << "_of(ids[q]) != probe[i] ? " << none << " : "
+             << result_type() << (mapped ? "(table, &table->rows[ids[q]])" : "(columns, ids[q])")
+             << ";" << std::endl
+             << "    }" << std::endl
+             << "  }" << std::endl << std::endl;
+        continue;
+      }
+      if (component_->concurrency() == "sharded") {
+        ofs_ << "    for (std::size_t i = 0; i < count; ++i) {" << std::endl
+             << "      out[i] = find_by_" << alias << "(" << batch_arguments(ndx, "keys[i]")
+             << ");" << std::endl
+             << "    }" << std::endl
+             << "  }" << std::endl << std::endl;
+        continue;
+      }
+
+      bool hashed = ndx->type().compare(0, 6, "hashed") == 0;
+      if (ndx->is_flat()) {
+        std::string table = row_class + "_table";
+        std::string of = table + "::" + alias + "_of";
+        bool eytzinger = ndx->type() == "eytzinger";
+        ofs_ << "    std::vector<" << table << "::" << alias
+             << "_key> probe(keys, keys + count);" << std::endl
+             << "    std::vector<std::size_t> found(count);" << std::endl;
+        implement_table_access();
+        ofs_ << "    const auto& rows = table.rows;" << std::endl
+             << "    const auto& ids = table." << alias << "_ids;" << std::endl
+             << "    auto below = [&rows, &probe](std::size_t i, std::uint32_t row) {"
+             << std::endl
+             << "      return " << of << "(rows[row]) < probe[i];" << std::endl
+             << "    };" << std::endl
+             << "    framework::"
+             << (eytzinger ? "eytzinger_lower_bound_batch" : "branchless_lower_bound_batch")
+             << "(ids, count, below, found.data());" << std::endl
+             << "    for (std::size_t i = 0; i < count; ++i) {" << std::endl
+             << "      std::size_t q = found[i];" << std::endl
+             << "      out[i] = q == " << (eytzinger ? "0" : "ids.size()")
+             << " || " << of << "(rows[ids[q]]) != probe[i] ? " << none << " : "
+             << hold("rows[ids[q]]") << ";" << std::endl
+             << "    }" << std::endl
+             << "  }" << std::endl << std::endl;
+        continue;
+      }
 
-      index::ptr ndx = *a;
-      std::string type = ndx->type();
-      std::string alias = ndx->alias();
-      size_t nkeys = ndx->get_index_pairs().size();
-      bool composite = nkeys > 1;
-      if (type == "ordered-unique") {
-        ofs_ << "        mti::ordered_unique<" << std::endl;
+      implement_table_access();
+      ofs_ << "    const auto& p = table.get<" << alias << "_tag>();" << std::endl;
+      if (hashed) {
+        ofs_ << "    const std::size_t ahead = 8;" << std::endl;
       }
-      else if (type == "ordered-non-unique") {
-        ofs_ << "        mti::ordered_non_unique<" << std::endl;
+      ofs_ << "    for (std::size_t i = 0; i < count; ++i) {" << std::endl;
+      if (hashed) {
+        ofs_ << "      if (i + 2 * ahead < count) {" << std::endl
+             << "        framework::prefetch_bucket(p, "
+             << batch_lookup(ndx, "keys[i + 2 * ahead]") << ");" << std::endl
+             << "      }" << std::endl
+             << "      if (i + ahead < count) {" << std::endl
+             << "        framework::prefetch_bucket_value(p, "
+             << batch_lookup(ndx, "keys[i + ahead]") << ");" << std::endl
+             << "      }" << std::endl;
       }
-      else if (type == "hashed-unique") {
-        ofs_ << "        mti::hashed_unique<" << std::endl;
+      ofs_ << "      auto q = p.find(" << batch_lookup(ndx, "keys[i]") << ");" << std::endl
+           << "      out[i] = q != p.end() ? " << hold("*q") << " : " << none << ";"
+           << std::endl
+           << "    }" << std::endl
+           << "  }" << std::endl << std::endl;
+    }
+  }
+
+  inline void
+  mapping_maker::
+  implement_range_finders() {
+
+    std::string class_name = component_->class_name() + "_mapping";
+    std::string row_class = component_->class_name();
+    bool sharded = component_->concurrency() == "sharded";
+    bool header = false;
+    for (auto ndx : component_->get_indices()) {
+
+      if (! has_range(ndx)) {
+        continue;
       }
-      else if (type == "hashed-non-unique") {
-        ofs_ << "        mti::hashed_non_unique<" << std::endl;
+      if (! header) {
+        ofs_ << "  //////" << std::endl
+             << "  /// range finders" << std::endl
+             << "  //////" << std::endl << std::endl;
+        header = true;
       }
-      ofs_ << "          mti::tag<"
-           << alias
-           << "_tag>,"
-           << std::endl;
-      if (! composite) {
+      std::string alias = ndx->alias();
+      std::string lookup = key_lookup(ndx);
+      std::string tag = alias + "_tag";
 
-        auto c = ndx->get_index_pairs().begin();
-        std::string kname = c->first;
-        std::string ktype = c->second;
-        if (ktype == "std::string") {
-          ktype = "const std::string&";
-        }
-        ofs_ << "          mti::const_mem_fun<"
-             << class_name
-             << ", "
-             << ktype
-             << ", &"
-             << class_name
-             << "::"
-             << kname
-             << ">"
-             << std::endl;
+      ofs_ << "  inline " << class_name << "::" << alias << "_range" << std::endl
+           << "  " << class_name << "::" << std::endl;
+      declare_key_parameters("  find_all_by_" + alias + "(", ndx, ") {");
+      ofs_ << std::endl;
+      if (sharded) {
+        ofs_ << "    std::vector<" << element_type() << "> rows;" << std::endl
+             << "    for (auto& s : shards_) {" << std::endl
+             << "      std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+             << "      auto r = s.table_.get<" << tag << ">().equal_range(" << lookup << ");"
+             << std::endl
+             << "      rows.insert(rows.end(), r.first, r.second);" << std::endl
+             << "    }" << std::endl;
+      }
+      else if (component_->allocation() == "arena") {
+        ofs_ << "    auto generation = current();" << std::endl
+             << "    auto r = generation->table.get<" << tag << ">().equal_range("
+             << lookup << ");" << std::endl
+             << "    return " << alias << "_range(r.first, r.second, "
+             << "std::move(generation));" << std::endl;
+      }
+      else if (component_->concurrency() == "snapshot") {
+        ofs_ << "    auto table = std::atomic_load(&" << row_class << "_table_);"
+             << std::endl
+             << "    auto r = table->get<" << tag << ">().equal_range("
+             << lookup << ");" << std::endl
+             << "    return " << alias << "_range(r.first, r.second, "
+             << "std::move(table));" << std::endl;
       }
       else {
-        ofs_ << "          mti::composite_key<"
+        ofs_ << "    std::shared_ptr<const " << row_class << "_table> table;" << std::endl
+             << "    {" << std::endl
+             << "      std::lock_guard<std::mutex>  guard(lock_);" << std::endl
+             << "      table = " << row_class << "_table_;" << std::endl
+             << "    }" << std::endl
+             << "    auto r = table->get<" << tag << ">().equal_range(" << lookup << ");"
              << std::endl
-             << "            "
-             << class_name
-             << "::ptr,"
+             << "    return " << alias << "_range(r.first, r.second, "
+             << "std::move(table));" << std::endl;
+      }
+      if (sharded) {
+        ofs_ << "    auto owned = std::make_shared<const std::vector<" << element_type()
+             << ">>(std::move(rows));" << std::endl
+             << "    auto first = owned->begin();" << std::endl
+             << "    auto last = owned->end();" << std::endl
+             << "    return " << alias << "_range(first, last, std::move(owned));"
              << std::endl;
+      }
+      ofs_ << "  }" << std::endl << std::endl;
 
-        auto c = ndx->get_index_pairs().begin();
-        auto d = ndx->get_index_pairs().end();
-        size_t dn = std::distance(c, d);
-
-        for (size_t e = 0; c != d; ++c, ++e) {
-          std::string kname = c->first;
-          std::string ktype = c->second;
-          if (ktype == "std::string") {
-            ktype = "const std::string&";
-          }
-          ofs_ << "            mti::const_mem_fun<"
-               << class_name
-               << ", "
-               << ktype
-               << ", &"
-               << class_name
-               << "::"
-               << kname
-               << ">";
-          if (e < dn - 1) {
-            ofs_ << ",";
-          }
-          ofs_ << std::endl;
-        }
-        ofs_ << "          >" << std::endl;
+      ofs_ << "  inline std::size_t" << std::endl
+           << "  " << class_name << "::" << std::endl;
+      declare_key_parameters("  count_by_" + alias + "(", ndx, ") {");
+      ofs_ << std::endl;
+      if (sharded) {
+        ofs_ << "    std::size_t n = 0;" << std::endl
+             << "    for (auto& s : shards_) {" << std::endl
+             << "      std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+             << "      n += s.table_.get<" << tag << ">().count(" << lookup << ");"
+             << std::endl
+             << "    }" << std::endl
+             << "    return n;" << std::endl;
       }
-      ofs_ << "        >";
-      if (i < n - 1) {
-        ofs_ << ",";
+      else {
+        implement_table_access();
+        ofs_ << "    return table.get<" << tag << ">().count(" << lookup << ");"
+             << std::endl;
       }
+      ofs_ << "  }" << std::endl << std::endl;
+
+      ofs_ << "  inline bool" << std::endl
+           << "  " << class_name << "::" << std::endl;
+      declare_key_parameters("  exists_by_" + alias + "(", ndx, ") {");
       ofs_ << std::endl;
+      if (sharded) {
+        ofs_ << "    for (auto& s : shards_) {" << std::endl
+             << "      std::lock_guard<std::mutex>  guard(s.lock_);" << std::endl
+             << "      const auto& p = s.table_.get<" << tag << ">();" << std::endl
+             << "      if (p.find(" << lookup << ") != p.end()) return true;" << std::endl
+             << "    }" << std::endl
+             << "    return false;" << std::endl;
+      }
+      else {
+        implement_table_access();
+        ofs_ << "    const auto& p = table.get<" << tag << ">();" << std::endl
+             << "    return p.find(" << lookup << ") != p.end();" << std::endl;
+      }
+      ofs_ << "  }" << std::endl << std::endl;
     }
-    ofs_ << "      >" << std::endl;
-    ofs_ << "    > " << class_name << "_table;" << std::endl;
-    ofs_ << std::endl;
+  }
 
-    ofs_ << "    //////" << std::endl
-         << "    /// boost multi-index indices" << std::endl
-         << "    //////" << std::endl;
+  inline
+  bench_maker::
+  bench_maker(std::ostream& ofs,
+              component::ptr comp) :
+    ofs_(ofs),
+    component_(comp) {
+  }
 
-    a = component_->get_indices().begin();
-    b = component_->get_indices().end();
-    size_t mlen = 0;
-    for (; a != b; ++a) {
-      index::ptr ndx = *a;
-      if (ndx->alias().size() > mlen) {
-        mlen = ndx->alias().size();
+  inline void
+  bench_maker::
+  make() {
+    declare_prologue();
+    declare_connection();
+    declare_keys();
+    declare_load();
+    for (auto ndx : component_->get_indices()) {
+      declare_finder(ndx);
+      if (component_->batch_finders()) {
+        declare_batch_finder(ndx);
       }
     }
-    a = component_->get_indices().begin();
-    b = component_->get_indices().end();
-    for (; a != b; ++a) {
-      index::ptr ndx = *a;
-      ofs_ << "    using "
-           << ndx->alias()
-           << "_index"
-           << std::string(mlen - ndx->alias().size(), ' ')
-           << " = "
-           << class_name
-           << "_table::index<"
-           << ndx->alias()
-           << "_tag>::type;"
+    declare_epilogue();
+  }
+
+  inline void
+  bench_maker::
+  declare_prologue() {
+
+    std::string class_name = component_->class_name();
+    size_t rows = component_->expected_rows() > 0 ? component_->expected_rows() : 100000;
+    ofs_ << "#include <chrono>" << std::endl
+         << "#include <cstddef>" << std::endl
+         << "#include <memory>" << std::endl
+         << "#include <string>" << std::endl
+         << "#include <vector>" << std::endl
+         << "#include <benchmark/benchmark.h>" << std::endl
+         << "#include <framework/bench/allocations.hpp>" << std::endl
+         << "#include <framework/synthetic.hpp>" << std::endl
+         << "#include \"" << class_name << ".hpp\"" << std::endl << std::endl
+         << "namespace {" << std::endl << std::endl
+         << "  using namespace rates;" << std::endl
+         << "  using namespace rates::generated;" << std::endl << std::endl
+         << "  //////" << std::endl
+         << "  /// the synthetic table, columns of the first unique index hold a" << std::endl
+         << "  /// value per row, every other column repeats each value on" << std::endl
+         << "  /// repeats rows, finders cycle through lookups sampled rows" << std::endl
+         << "  //////" << std::endl
+         << "  const std::size_t rows        = " << rows << ";" << std::endl
+         << "  const std::size_t repeats     = 16;" << std::endl
+         << "  const std::size_t lookups     = 4096;" << std::endl
+         << "  const std::size_t batch_size  = 64;" << std::endl << std::endl;
+  }
+
+  inline void
+  bench_maker::
+  declare_connection() {
+
+    ofs_ << "  //////" << std::endl
+         << "  /// synthetic connection" << std::endl
+         << "  //////" << std::endl
+         << "  connection_ptr" << std::endl
+         << "  synthetic_connection() {" << std::endl << std::endl
+         << "    auto conn = std::make_shared<connection>(rows);" << std::endl;
+    for (auto fld : columns()) {
+      ofs_ << "    conn->column(\"" << fld->db_name() << "\", " << column_width(fld) << ", "
+           << (is_unique_column(fld->db_name()) ? "rows" : "rows / repeats") << ");"
            << std::endl;
     }
-    ofs_ << std::endl;
-    ofs_ << "    //////" << std::endl
-         << "    /// the "
-         << class_name
-         << " table itself" << std::endl
-         << "    //////" << std::endl;
-    ofs_ << "    "
-         << class_name
-         << "_table  "
-         << class_name
-         << "_table_;"
-         << std::endl
-         << std::endl;
-    ofs_ << "    //////" << std::endl
-         << "    /// synchronizes access to singleton data" << std::endl
-         << "    //////" << std::endl
-         << "    std::mutex  lock_;" << std::endl
-         << "  };" << std::endl << std::endl;
+    ofs_ << "    return conn;" << std::endl
+         << "  }" << std::endl << std::endl;
   }
 
   inline void
-  mapping_maker::
-  implement_singleton_accessor() {
+  bench_maker::
+  declare_keys() {
 
-    std::string class_name = component_->class_name() + "_mapping";
+    fields keys = key_fields();
+    if (keys.empty()) {
+      return;
+    }
     ofs_ << "  //////" << std::endl
-         << "  /// singleton accessor" << std::endl
+         << "  /// lookup keys, the index fields of the sampled rows as the" << std::endl
+         << "  /// loaded rows hold them" << std::endl
          << "  //////" << std::endl
-         << "  inline " << class_name << "& " << std::endl
-         << "  " << class_name << "::" << std::endl
-         << "  instance() {" << std::endl
-         << "    static " << class_name << " instance_;" << std::endl
-         << "    return instance_;" << std::endl
+         << "  struct lookup_keys {" << std::endl;
+    size_t width = 0;
+    for (auto fld : keys) {
+      width = std::max(width, fld->type().size());
+    }
+    for (auto fld : keys) {
+      std::string type = "std::vector<" + fld->type() + ">";
+      ofs_ << "    " << type << std::string(width + 15 - type.size(), ' ')
+           << fld->name() << ";" << std::endl;
+    }
+    ofs_ << "  };" << std::endl << std::endl
+         << "  const lookup_keys&" << std::endl
+         << "  keys() {" << std::endl << std::endl
+         << "    static const lookup_keys keys = [] {" << std::endl
+         << "      lookup_keys k;" << std::endl
+         << "      for (std::size_t i = 0; i < lookups; ++i) {" << std::endl
+         << "        std::size_t row = i * 7919 % rows;" << std::endl;
+    for (auto fld : keys) {
+      ofs_ << "        k." << fld->name() << ".push_back(" << key_value(fld, "row") << ");"
+           << std::endl;
+    }
+    ofs_ << "      }" << std::endl
+         << "      return k;" << std::endl
+         << "    }();" << std::endl
+         << "    return keys;" << std::endl
          << "  }" << std::endl << std::endl;
   }
 
   inline void
-  mapping_maker::
-  implement_load() {
+  bench_maker::
+  declare_load() {
 
     std::string class_name = component_->class_name();
+    std::string mapping = class_name + "_mapping";
     ofs_ << "  //////" << std::endl
-         << "  /// load" << std::endl
+         << "  /// what loading the synthetic table costs, measured once from" << std::endl
+         << "  /// whichever benchmark comes first, the allocations leave out the" << std::endl
+         << "  /// ones the synthetic connection makes producing the rows" << std::endl
          << "  //////" << std::endl
-         << "  inline bool" << std::endl
-         << "  " << class_name << "_mapping" << "::" << std::endl
-         << "  load(connection_ptr conn) {"
-         << std::endl << std::endl
-         << "    std::lock_guard<std::mutex>  guard(lock_);"
-         << std::endl;
-
-    const auto& sps = component_->get_stored_procs();
-    auto i = sps.find("read");
-    auto sp = i->second;
-    ofs_ << "    "
-         << "std::string sp = \"exec "
-         << sp->name()
-         << "\";"
-         << std::endl;
-    ofs_ << "    " << class_name << " area;" << std::endl
-         << "    int result = conn->execute(sp);" << std::endl
-         << "    if (result == FAIL) return false;" << std::endl << std::endl
+         << "  struct load_cost {" << std::endl
+         << "    double       seconds;" << std::endl
+         << "    std::size_t  allocations;" << std::endl
+         << "  };" << std::endl << std::endl
+         << "  std::size_t" << std::endl
+         << "  connection_allocations() {" << std::endl << std::endl
+         << "    auto conn = synthetic_connection();" << std::endl
+         << "    " << class_name << " area;" << std::endl
+         << "    framework::allocation_count allocated;" << std::endl
+         << "    conn->execute(\"\");" << std::endl
          << "    area.bind(conn);" << std::endl
          << "    while (conn->nextRow() != NO_MORE_ROWS) {" << std::endl
-         << "      " << class_name << "::ptr row = std::make_shared<"
-         << class_name << ">(area);" << std::endl
-         << "      " << class_name << "_table_.insert(row);" << std::endl
-         << "    }"
+         << "    }" << std::endl
+         << "    return allocated.count();" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  const load_cost&" << std::endl
+         << "  first_load() {" << std::endl << std::endl
+         << "    static const load_cost cost = [] {" << std::endl
+         << "      std::size_t produced = connection_allocations();" << std::endl
+         << "      auto conn = synthetic_connection();" << std::endl
+         << "      framework::allocation_count allocated;" << std::endl
+         << "      auto start = std::chrono::steady_clock::now();" << std::endl
+         << "      " << mapping << "::instance().load(conn);" << std::endl
+         << "      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;"
          << std::endl
-         << "    return true;" << std::endl
-         << "  }" << std::endl << std::endl;
+         << "      std::size_t count = allocated.count();" << std::endl
+         << "      return load_cost{elapsed.count(), count > produced ? count - produced : 0};"
+         << std::endl
+         << "    }();" << std::endl
+         << "    return cost;" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  " << mapping << "&" << std::endl
+         << "  loaded() {" << std::endl
+         << "    first_load();" << std::endl
+         << "    return " << mapping << "::instance();" << std::endl
+         << "  }" << std::endl << std::endl
+         << "  //////" << std::endl
+         << "  /// load, items per second is rows per second" << std::endl
+         << "  //////" << std::endl
+         << "  void" << std::endl
+         << "  BM_load(benchmark::State& state) {" << std::endl << std::endl
+         << "    for (auto _ : state) {" << std::endl
+         << "      state.SetIterationTime(first_load().seconds);" << std::endl
+         << "    }" << std::endl
+         << "    state.SetItemsProcessed(state.iterations() * rows);" << std::endl
+         << "    state.counters[\"allocs_per_row\"] =" << std::endl
+         << "      static_cast<double>(first_load().allocations) / rows;" << std::endl
+         << "  }" << std::endl
+         << "  BENCHMARK(BM_load)->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);"
+         << std::endl << std::endl
+         << "  //////" << std::endl
+         << "  /// teardown, loading an empty result drops the loaded table, which" << std::endl
+         << "  /// is loaded again afterwards for the finders" << std::endl
+         << "  //////" << std::endl
+         << "  void" << std::endl
+         << "  BM_teardown(benchmark::State& state) {" << std::endl << std::endl
+         << "    auto& mapping = loaded();" << std::endl
+         << "    for (auto _ : state) {" << std::endl
+         << "      auto empty = std::make_shared<connection>(0);" << std::endl
+         << "      auto start = std::chrono::steady_clock::now();" << std::endl
+         << "      mapping.load(empty);" << std::endl
+         << "      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;"
+         << std::endl
+         << "      state.SetIterationTime(elapsed.count());" << std::endl
+         << "    }" << std::endl
+         << "    mapping.load(synthetic_connection());" << std::endl
+         << "    state.SetItemsProcessed(state.iterations() * rows);" << std::endl
+         << "  }" << std::endl
+         << "  BENCHMARK(BM_teardown)->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);"
+         << std::endl << std::endl;
   }
 
   inline void
-  mapping_maker::
-  implement_finders() {
+  bench_maker::
+  declare_finder(index::ptr ndx) {
 
-    std::string class_name = component_->class_name() + "_mapping";
+    std::string name = "BM_find_by_" + ndx->alias();
     ofs_ << "  //////" << std::endl
-         << "  /// finders" << std::endl
-         << "  //////" << std::endl << std::endl;
+         << "  /// find_by_" << ndx->alias() << ", one thread gives the latency, more" << std::endl
+         << "  /// the throughput under concurrent readers" << std::endl
+         << "  //////" << std::endl
+         << "  void" << std::endl
+         << "  " << name << "(benchmark::State& state) {" << std::endl << std::endl
+         << "    auto& mapping = loaded();" << std::endl
+         << "    const auto& k = keys();" << std::endl
+         << "    std::size_t i = state.thread_index() * lookups / state.threads();" << std::endl
+         << "    std::size_t hits = 0;" << std::endl
+         << "    for (auto _ : state) {" << std::endl
+         << "      std::size_t j = i++ % lookups;" << std::endl
+         << "      hits += static_cast<bool>(mapping.find_by_" << ndx->alias() << "("
+         << finder_arguments(ndx, "j") << "));" << std::endl
+         << "    }" << std::endl
+         << "    state.SetItemsProcessed(state.iterations());" << std::endl
+         << "    state.counters[\"hit_rate\"] = benchmark::Counter(" << std::endl
+         << "      static_cast<double>(hits) / state.iterations(), benchmark::Counter::kAvgThreads);"
+         << std::endl
+         << "  }" << std::endl
+         << "  BENCHMARK(" << name << ")->ThreadRange(1, framework::synthetic_threads());"
+         << std::endl << std::endl;
+  }
 
-    auto p = component_->get_indices().begin();
-    auto q = component_->get_indices().end();
-    for (; p != q; ++p) {
+  inline void
+  bench_maker::
+  declare_batch_finder(index::ptr ndx) {
 
-      index::ptr ndx = *p;
-      std::string alias = ndx->alias();
-      std::string line = "  find_by_" + alias + "(";
-      size_t len = line.size();
-      ofs_ << "  inline " << component_->class_name() + "::ptr " << std::endl
-           << "  " << class_name << "::" << std::endl
-           << line;
-
-      auto c = ndx->get_index_pairs().begin();
-      auto d = ndx->get_index_pairs().end();
-      size_t i = 0;
-      size_t n = std::distance(c, d);
-      for (; c != d; ++c, ++i) {
-
-        std::string name = c->first;
-        std::string type = c->second;
-        if (i != 0) {
-          ofs_ << std::string(len, ' ');
-        }
-        if (type == "std::string") {
-          ofs_ << "const std::string& ";
-        }
-        else {
-          ofs_ << type << " ";
-        }
-        ofs_ << name;
-        if (i < n - 1) {
-          ofs_ << ",";
-        }
-        else {
-          ofs_ << ") {";
-        }
-        ofs_ << std::endl;
+    std::string alias = ndx->alias();
+    std::string name = "BM_find_by_" + alias + "_batch";
+    std::string mapping = component_->class_name() + "_mapping";
+    ofs_ << "  //////" << std::endl
+         << "  /// find_by_" << alias << "_batch, batch_size keys a call" << std::endl
+         << "  //////" << std::endl
+         << "  void" << std::endl
+         << "  " << name << "(benchmark::State& state) {" << std::endl << std::endl
+         << "    auto& mapping = loaded();" << std::endl
+         << "    const auto& k = keys();" << std::endl
+         << "    std::vector<" << mapping << "::" << alias << "_key> batch;" << std::endl
+         << "    for (std::size_t i = 0; i < lookups; ++i) {" << std::endl
+         << "      batch.push_back(" << mapping << "::" << alias << "_key{"
+         << finder_arguments(ndx, "i") << "});" << std::endl
+         << "    }" << std::endl
+         << "    std::vector<decltype(mapping.find_by_" << alias << "("
+         << finder_arguments(ndx, "0") << "))> out(batch_size);" << std::endl
+         << "    std::size_t i = 0;" << std::endl
+         << "    std::size_t hits = 0;" << std::endl
+         << "    for (auto _ : state) {" << std::endl
+         << "      mapping.find_by_" << alias << "_batch(&batch[i], batch_size, out.data());"
+         << std::endl
+         << "      for (std::size_t j = 0; j < batch_size; ++j) {" << std::endl
+         << "        hits += static_cast<bool>(out[j]);" << std::endl
+         << "      }" << std::endl
+         << "      i = (i + batch_size) % lookups;" << std::endl
+         << "    }" << std::endl
+         << "    state.SetItemsProcessed(state.iterations() * batch_size);" << std::endl
+         << "    state.counters[\"hit_rate\"] = benchmark::Counter(" << std::endl
+         << "      static_cast<double>(hits) / (state.iterations() * batch_size),"
+         << std::endl
+         << "      benchmark::Counter::kAvgThreads);" << std::endl
+         << "  }" << std::endl
+         << "  BENCHMARK(" << name << ");" << std::endl << std::endl;
+  }
+
+  inline void
+  bench_maker::
+  declare_epilogue() {
+    ofs_ << "}" << std::endl << std::endl
+         << "BENCHMARK_MAIN();" << std::endl;
+  }
+
+  //////
+  /// the fields some index keys on, in field order
+  //////
+  inline fields
+  bench_maker::
+  key_fields() {
+
+    std::set<std::string> names;
+    for (auto ndx : component_->get_indices()) {
+      for (const auto& pair : ndx->get_index_pairs()) {
+        names.insert(pair.first);
       }
-      ofs_ << std::endl;
-      ofs_ << "    std::lock_guard<std::mutex>  guard(lock_);"
-           << std::endl;
-      ofs_ << "    const auto& p = "
-           << component_->class_name() + "_table_.get<"
-           << alias << "_tag>();"
-           << std::endl
-           << "    auto q = p.find(";
-      bool is_composite = n > 1;
-      if (is_composite) {
-        ofs_ << "boost::make_tuple(";
-      }
-      c = ndx->get_index_pairs().begin();
-      d = ndx->get_index_pairs().end();
-      i = 0;
-      for (; c != d; ++c, ++i) {
-
-        std::string name = c->first;
-        ofs_ << name;
-        if (i < n - 1) {
-          ofs_ << ",";
-        }
-        else {
-          ofs_ << ")";
-          if (is_composite) {
-            ofs_ << ")";
-          }
-          ofs_ << ";";
-        }
+    }
+    fields keys;
+    for (auto fld : component_->get_fields()) {
+      if (names.count(fld->name())) {
+        keys.push_back(fld);
       }
-      ofs_ << std::endl;
-      ofs_ << "    return q != p.end() ? *q : "
-           << component_->class_name()
-           << "::ptr();"
-           << std::endl
-           << "  }"
-           << std::endl << std::endl;
     }
+    return keys;
+  }
+
+  //////
+  /// one field per database column, the first one bound to it
+  //////
+  inline fields
+  bench_maker::
+  columns() {
+
+    std::set<std::string> seen;
+    fields cols;
+    for (auto fld : component_->get_fields()) {
+      if (seen.insert(fld->db_name()).second) {
+        cols.push_back(fld);
+      }
+    }
+    return cols;
+  }
+
+  inline bool
+  bench_maker::
+  is_unique_column(const std::string& db_name) {
+
+    index::ptr unique = component_->unique_index();
+    if (! unique) {
+      return false;
+    }
+    for (const auto& pair : unique->get_index_pairs()) {
+      field::ptr fld = component_->get_field(pair.first);
+      if (fld && fld->db_name() == db_name) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //////
+  /// the width of the column fld is bound to, numbers have none
+  //////
+  inline std::string
+  bench_maker::
+  column_width(field::ptr fld) {
+
+    for (auto col : columns()) {
+      if (col->db_name() == fld->db_name()) {
+        return std::to_string(col->type() == "std::string" ? col->size() : 0);
+      }
+    }
+    return "0";
+  }
+
+  //////
+  /// what the connection wrote into fld for row, a std::string member
+  /// keeps the whole bound buffer
+  //////
+  inline std::string
+  bench_maker::
+  key_value(field::ptr fld, const std::string& row) {
+
+    std::string distinct = is_unique_column(fld->db_name()) ? "rows" : "rows / repeats";
+    std::string key = "framework::synthetic_key(" + row + ", " + distinct + ")";
+    if (fld->type() != "std::string") {
+      return "framework::synthetic_number<" + fld->type() + ">(" + key + ")";
+    }
+    std::string width = column_width(fld);
+    std::string text = "framework::synthetic_text(\"" + fld->db_name() + "\", " + key + ", " +
+                       width + ")";
+    if (component_->is_fixed(fld) || component_->is_encoded(fld)) {
+      return text;
+    }
+    return "framework::synthetic_padded(" + text + ", " + width + ")";
+  }
+
+  inline std::string
+  bench_maker::
+  finder_arguments(index::ptr ndx, const std::string& at) {
+
+    std::string args;
+    for (const auto& pair : ndx->get_index_pairs()) {
+      if (! args.empty()) {
+        args += ", ";
+      }
+      args += "k." + pair.first + "[" + at + "]";
+    }
+    return args;
   }
 
 }}
@@ -1,16 +1,29 @@
 #pragma once
 
-#include <set>
-#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/mem_fun.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/ordered_index.hpp>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/indexed_by.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <framework/bulk.hpp>
+#include <framework/range.hpp>
+#include <framework/snapshot.hpp>
+#include <framework/sql.hpp>
+#include <framework/write_behind.hpp>
 #include <db/connection.hpp>
 
 namespace rates {
@@ -187,12 +200,42 @@ namespace generated {
     //////
     bool load(connection_ptr);
 
+    //////
+    /// warm restart, save writes the table to a binary file and load
+    /// reads one the way load does, files of another schema are refused
+    //////
+    bool save_snapshot(const std::string& path);
+    bool load_snapshot(const std::string& path);
+
+    //////
+    /// partitioned load, one read per AM_COLLECT value runs concurrently on its
+    /// own connection from connect, which must be thread safe, the rows
+    /// of all partitions then go into a fresh table that replaces the
+    /// current one, a row no partition returned is gone afterwards
+    //////
+    bool load_partitioned(const std::vector<std::string>& partitions,
+                          std::function<connection_ptr()> connect);
+
+    //////
+    /// write behind, save and save_batch queue rows for the insert proc
+    /// and return at once, the writer thread executes what is queued in
+    /// exec batches of up to batch_size rows, waiting up to linger for a
+    /// batch to fill, a future turns true once its batch was executed,
+    /// the table sees saved rows on the next load
+    //////
+    void start_writer(std::function<connection_ptr()> connect,
+                      std::size_t batch_size,
+                      std::chrono::milliseconds linger);
+    void stop_writer();
+    std::future<bool> save(const position_source::ptr& row);
+    std::future<bool> save_batch(std::vector<position_source::ptr> rows);
+
     //////
     /// finder methods
     //////
-    position_source::ptr find_by_composite_key(const std::string& source,
+    position_source::ptr find_by_composite_key(std::string_view source,
                                                int index);
-    position_source::ptr find_by_source(const std::string& source);
+    position_source::ptr find_by_source(std::string_view source);
     position_source::ptr find_by_index(int index);
 
   private:
@@ -221,15 +264,21 @@ namespace generated {
             position_source::ptr,
             mti::const_mem_fun<position_source, const std::string&, &position_source::source>,
             mti::const_mem_fun<position_source, int, &position_source::index>
+          >,
+          mti::composite_key_compare<
+            std::less<>,
+            std::less<>
           >
         >,
         mti::ordered_non_unique<
           mti::tag<source_tag>,
-          mti::const_mem_fun<position_source, const std::string&, &position_source::source>
+          mti::const_mem_fun<position_source, const std::string&, &position_source::source>,
+          std::less<>
         >,
         mti::ordered_non_unique<
           mti::tag<index_tag>,
-          mti::const_mem_fun<position_source, int, &position_source::index>
+          mti::const_mem_fun<position_source, int, &position_source::index>,
+          std::less<>
         >
       >
     > position_source_table;
@@ -242,16 +291,73 @@ namespace generated {
     using index_index         = position_source_table::index<index_tag>::type;
 
     //////
-    /// the position_source table itself
+    /// the position_source table, replaced whole by load, a range keeps the one
+    /// it came from alive
     //////
-    position_source_table  position_source_table_;
+    std::shared_ptr<position_source_table>  position_source_table_;
 
     //////
     /// synchronizes access to singleton data
     //////
     std::mutex  lock_;
+
+    //////
+    /// rows fetched by the last load, sizes the next one, guarded by lock_
+    //////
+    std::size_t  loaded_rows_;
+
+    //////
+    /// hash of the generator release and the fields snapshot files are
+    /// written with
+    //////
+    static constexpr std::uint64_t  snapshot_schema = 0x97261a168bc496c5ull;
+
+    //////
+    /// reads one partition into rows, runs on a load_partitioned thread
+    //////
+    static bool fetch_partition(connection_ptr conn,
+                                const std::string& partition,
+                                std::vector<position_source>& rows);
+
+    //////
+    /// renders rows as one exec batch of the insert proc and executes it
+    //////
+    static bool insert_rows(connection_ptr conn,
+                            const position_source::ptr* rows,
+                            std::size_t count);
+
+    //////
+    /// the write behind queue, swapped whole by start and stop
+    //////
+    std::shared_ptr<framework::write_behind<position_source::ptr>>  writer_;
+
+  public:
+
+    //////
+    /// range finders for the non-unique indices, a range keeps the table
+    /// it came from alive, count and exists touch no rows
+    //////
+    using source_range = framework::range<source_index::const_iterator, std::shared_ptr<const position_source_table>>;
+    using index_range  = framework::range<index_index::const_iterator, std::shared_ptr<const position_source_table>>;
+
+    source_range find_all_by_source(std::string_view source);
+    std::size_t count_by_source(std::string_view source);
+    bool exists_by_source(std::string_view source);
+    index_range find_all_by_index(int index);
+    std::size_t count_by_index(int index);
+    bool exists_by_index(int index);
   };
 
+  //////
+  /// default constructor
+  //////
+  inline
+  position_source_mapping::
+  position_source_mapping() :
+    position_source_table_(std::make_shared<position_source_table>()),
+    loaded_rows_(0) {
+  }
+
   //////
   /// singleton accessor
   //////
@@ -275,35 +381,224 @@ namespace generated {
     int result = conn->execute(sp);
     if (result == FAIL) return false;
 
+    std::vector<position_source::ptr> rows;
+    rows.reserve(loaded_rows_);
+    auto table = std::make_shared<position_source_table>();
     area.bind(conn);
     while (conn->nextRow() != NO_MORE_ROWS) {
       position_source::ptr row = std::make_shared<position_source>(area);
-      position_source_table_.insert(row);
+      rows.push_back(std::move(row));
+    }
+    framework::bulk_insert(*table, rows);
+    loaded_rows_ = rows.size();
+    position_source_table_ = std::move(table);
+    return true;
+  }
+
+  //////
+  /// partitioned load
+  //////
+
+  inline bool
+  position_source_mapping::
+  fetch_partition(connection_ptr conn,
+                  const std::string& partition,
+                  std::vector<position_source>& rows) {
+
+    if (! conn) return false;
+    std::string sp = "exec vm_read_rate_source " + framework::sql_literal(partition);
+    position_source area;
+    int result = conn->execute(sp);
+    if (result == FAIL) return false;
+
+    area.bind(conn);
+    while (conn->nextRow() != NO_MORE_ROWS) {
+      rows.push_back(area);
+    }
+    return true;
+  }
+
+  inline bool
+  position_source_mapping::
+  load_partitioned(const std::vector<std::string>& partitions,
+                   std::function<connection_ptr()> connect) {
+
+    std::vector<std::vector<position_source>> fetched(partitions.size());
+    std::vector<std::future<bool>> fetches;
+    for (std::size_t i = 0; i < partitions.size(); ++i) {
+      fetches.push_back(std::async(std::launch::async, [&, i] {
+        return fetch_partition(connect(), partitions[i], fetched[i]);
+      }));
+    }
+    bool complete = true;
+    for (auto& f : fetches) {
+      complete = f.get() && complete;
+    }
+    if (! complete) return false;
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    std::vector<position_source::ptr> rows;
+    rows.reserve(loaded_rows_);
+    auto table = std::make_shared<position_source_table>();
+    for (auto& part : fetched) {
+      for (auto& area : part) {
+        position_source::ptr row = std::make_shared<position_source>(std::move(area));
+        rows.push_back(std::move(row));
+      }
     }
+    framework::bulk_insert(*table, rows);
+    loaded_rows_ = rows.size();
+    position_source_table_ = std::move(table);
     return true;
   }
 
+  //////
+  /// snapshot save
+  //////
+  inline bool
+  position_source_mapping::
+  save_snapshot(const std::string& path) {
+
+    framework::snapshot_writer out(path, snapshot_schema);
+    std::uint64_t count = 0;
+    std::lock_guard<std::mutex>  guard(lock_);
+    for (const auto& row : *position_source_table_) {
+      out.write_string(row->source());
+      out.write_string(row->type());
+      out.write_string(row->date());
+      out.write(row->index());
+      ++count;
+    }
+    return out.commit(count);
+  }
+
+  //////
+  /// snapshot load
+  //////
+  inline bool
+  position_source_mapping::
+  load_snapshot(const std::string& path) {
+
+    framework::snapshot_reader in(path, snapshot_schema);
+    if (! in) return false;
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    position_source area;
+    std::vector<position_source::ptr> rows;
+    rows.reserve(loaded_rows_);
+    auto table = std::make_shared<position_source_table>();
+    for (std::uint64_t i = 0; i < in.rows() && ! in.overrun(); ++i) {
+      area.source(framework::padded(in.read_string(), 64));
+      area.type(framework::padded(in.read_string(), 64));
+      area.date(framework::padded(in.read_string(), 64));
+      area.index(in.read<int>());
+      position_source::ptr row = std::make_shared<position_source>(area);
+      rows.push_back(std::move(row));
+    }
+    if (! in.complete()) {
+      return false;
+    }
+    framework::bulk_insert(*table, rows);
+    loaded_rows_ = rows.size();
+    position_source_table_ = std::move(table);
+    return true;
+  }
+
+  //////
+  /// write behind
+  //////
+
+  inline void
+  position_source_mapping::
+  start_writer(std::function<connection_ptr()> connect,
+               std::size_t batch_size,
+               std::chrono::milliseconds linger) {
+
+    auto flush = [connect](const position_source::ptr* rows, std::size_t count) {
+      connection_ptr conn = connect();
+      return conn && insert_rows(conn, rows, count);
+    };
+    auto next = std::make_shared<framework::write_behind<position_source::ptr>>(batch_size, linger, flush);
+    // the prior writer flushes its queue as it goes out of scope
+    auto prior = std::atomic_exchange(&writer_, next);
+  }
+
+  inline void
+  position_source_mapping::
+  stop_writer() {
+    // flushes the queue unless a save still holds the writer
+    auto prior = std::atomic_exchange(&writer_, std::shared_ptr<framework::write_behind<position_source::ptr>>());
+  }
+
+  inline std::future<bool>
+  position_source_mapping::
+  save(const position_source::ptr& row) {
+
+    auto writer = std::atomic_load(&writer_);
+    if (! writer) {
+      std::promise<bool> rejected;
+      rejected.set_value(false);
+      return rejected.get_future();
+    }
+    return writer->push(row);
+  }
+
+  inline std::future<bool>
+  position_source_mapping::
+  save_batch(std::vector<position_source::ptr> rows) {
+
+    auto writer = std::atomic_load(&writer_);
+    if (! writer) {
+      std::promise<bool> rejected;
+      rejected.set_value(false);
+      return rejected.get_future();
+    }
+    return writer->push(std::move(rows));
+  }
+
+  inline bool
+  position_source_mapping::
+  insert_rows(connection_ptr conn,
+              const position_source::ptr* rows,
+              std::size_t count) {
+
+    std::string sp;
+    for (std::size_t i = 0; i < count; ++i) {
+      const position_source& row = *rows[i];
+      sp += "exec vm_insert_rate_source ";
+      sp += framework::sql_literal(row.source());
+      sp += ", ";
+      sp += framework::sql_literal(row.type());
+      sp += ", ";
+      sp += framework::sql_literal(row.date());
+      sp += ", ";
+      sp += framework::sql_literal(row.index());
+      sp += "\n";
+    }
+    return conn->execute(sp) != FAIL;
+  }
+
   //////
   /// finders
   //////
 
   inline position_source::ptr 
   position_source_mapping::
-  find_by_composite_key(const std::string& source,
+  find_by_composite_key(std::string_view source,
                         int index) {
 
     std::lock_guard<std::mutex>  guard(lock_);
-    const auto& p = position_source_table_.get<composite_key_tag>();
+    const auto& p = position_source_table_->get<composite_key_tag>();
     auto q = p.find(boost::make_tuple(source,index));
     return q != p.end() ? *q : position_source::ptr();
   }
 
   inline position_source::ptr 
   position_source_mapping::
-  find_by_source(const std::string& source) {
+  find_by_source(std::string_view source) {
 
     std::lock_guard<std::mutex>  guard(lock_);
-    const auto& p = position_source_table_.get<source_tag>();
+    const auto& p = position_source_table_->get<source_tag>();
     auto q = p.find(source);
     return q != p.end() ? *q : position_source::ptr();
   }
@@ -313,9 +608,77 @@ namespace generated {
   find_by_index(int index) {
 
     std::lock_guard<std::mutex>  guard(lock_);
-    const auto& p = position_source_table_.get<index_tag>();
+    const auto& p = position_source_table_->get<index_tag>();
     auto q = p.find(index);
     return q != p.end() ? *q : position_source::ptr();
   }
 
+  //////
+  /// range finders
+  //////
+
+  inline position_source_mapping::source_range
+  position_source_mapping::
+  find_all_by_source(std::string_view source) {
+
+    std::shared_ptr<const position_source_table> table;
+    {
+      std::lock_guard<std::mutex>  guard(lock_);
+      table = position_source_table_;
+    }
+    auto r = table->get<source_tag>().equal_range(source);
+    return source_range(r.first, r.second, std::move(table));
+  }
+
+  inline std::size_t
+  position_source_mapping::
+  count_by_source(std::string_view source) {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    const auto& table = *position_source_table_;
+    return table.get<source_tag>().count(source);
+  }
+
+  inline bool
+  position_source_mapping::
+  exists_by_source(std::string_view source) {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    const auto& table = *position_source_table_;
+    const auto& p = table.get<source_tag>();
+    return p.find(source) != p.end();
+  }
+
+  inline position_source_mapping::index_range
+  position_source_mapping::
+  find_all_by_index(int index) {
+
+    std::shared_ptr<const position_source_table> table;
+    {
+      std::lock_guard<std::mutex>  guard(lock_);
+      table = position_source_table_;
+    }
+    auto r = table->get<index_tag>().equal_range(index);
+    return index_range(r.first, r.second, std::move(table));
+  }
+
+  inline std::size_t
+  position_source_mapping::
+  count_by_index(int index) {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    const auto& table = *position_source_table_;
+    return table.get<index_tag>().count(index);
+  }
+
+  inline bool
+  position_source_mapping::
+  exists_by_index(int index) {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    const auto& table = *position_source_table_;
+    const auto& p = table.get<index_tag>();
+    return p.find(index) != p.end();
+  }
+
 }}
@@ -0,0 +1,847 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/indexed_by.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <framework/fixed_string.hpp>
+#include <framework/flat_search.hpp>
+#include <framework/image.hpp>
+#include <framework/shared_image.hpp>
+#include <framework/snapshot.hpp>
+#include <framework/sql.hpp>
+#include <framework/write_behind.hpp>
+#include <db/connection.hpp>
+
+namespace rates {
+namespace generated {
+
+  /// namespace shortening for boost multi-index
+  namespace mti = boost::multi_index;
+
+  //////
+  /// class shared_position_source
+  //////
+  class shared_position_source {
+  public:
+
+    //////
+    /// the one shared ptr type
+    //////
+    using ptr = std::shared_ptr<shared_position_source>;
+
+    //////
+    /// default constructor
+    //////
+    shared_position_source();
+
+    //////
+    /// parameter constructor
+    //////
+    shared_position_source(std::string_view source,
+                           std::string_view type,
+                           std::string_view date,
+                           int index);
+
+    //////
+    /// accessors
+    //////
+    std::string_view source() const;
+    std::string_view type() const;
+    std::string_view date() const;
+    int index() const;
+
+    //////
+    /// mutators
+    //////
+    void source(std::string_view);
+    void type(std::string_view);
+    void date(std::string_view);
+    void index(int);
+
+    //////
+    /// bind
+    //////
+    void bind(connection_ptr conn);
+
+    //////
+    /// settle inline buffers after the connection wrote a row
+    //////
+    void fetched();
+
+  private:
+
+    //////
+    /// class members
+    //////
+    framework::fixed_string<64>  source_;
+    framework::fixed_string<64>  type_;
+    framework::fixed_string<64>  date_;
+    int                          index_;
+  };
+
+  static_assert(std::is_trivially_copyable<shared_position_source>::value,
+                "shared_position_source rows must stay one trivially copyable block");
+
+  //////
+  /// default constructor
+  //////
+  inline
+  shared_position_source::
+  shared_position_source() : 
+    source_(),
+    type_(),
+    date_(),
+    index_(0) {
+  }
+
+  //////
+  /// member constructor
+  //////
+  inline
+  shared_position_source::
+  shared_position_source(std::string_view source,
+                         std::string_view type,
+                         std::string_view date,
+                         int index) : 
+    source_(source),
+    type_(type),
+    date_(date),
+    index_(index) {
+  }
+
+  //////
+  /// accessors
+  //////
+
+  inline std::string_view
+  shared_position_source::
+  source() const {
+    return source_;
+  }
+
+  inline std::string_view
+  shared_position_source::
+  type() const {
+    return type_;
+  }
+
+  inline std::string_view
+  shared_position_source::
+  date() const {
+    return date_;
+  }
+
+  inline int
+  shared_position_source::
+  index() const {
+    return index_;
+  }
+
+  //////
+  /// mutators
+  //////
+
+  inline void
+  shared_position_source::
+  source(std::string_view source) {
+    source_ = source;
+  }
+
+  inline void
+  shared_position_source::
+  type(std::string_view type) {
+    type_ = type;
+  }
+
+  inline void
+  shared_position_source::
+  date(std::string_view date) {
+    date_ = date;
+  }
+
+  inline void
+  shared_position_source::
+  index(int index) {
+    index_ = index;
+  }
+
+  //////
+  /// bind
+  //////
+  inline void 
+  shared_position_source::
+  bind(connection_ptr conn) {
+
+    conn->genericBind("position_source", source_.data());
+    conn->genericBind("position_type", type_.data());
+    conn->genericBind("position_type", date_.data());
+    conn->genericBind("position_index", index_);
+  }
+
+  //////
+  /// fetched
+  //////
+  inline void
+  shared_position_source::
+  fetched() {
+    source_.terminate();
+    type_.terminate();
+    date_.terminate();
+  }
+
+  //////
+  /// class shared_position_source_mapping
+  //////
+  class shared_position_source_mapping {
+  public:
+
+    //////
+    /// singleton accessor
+    //////
+    static shared_position_source_mapping& instance();
+
+    //////
+    /// load
+    //////
+    bool load(connection_ptr);
+
+    //////
+    /// warm restart, save writes the table to a binary file and load
+    /// reads one the way load does, files of another schema are refused
+    //////
+    bool save_snapshot(const std::string& path);
+    bool load_snapshot(const std::string& path);
+
+    //////
+    /// save writes the current image to a file, open maps one read only
+    /// in place of the table, finders then read the mapped pages
+    //////
+    bool save_image(const std::string& path);
+    bool open_image(const std::string& path);
+
+    //////
+    /// publish copies the current image into shared memory as the next
+    /// generation of name, follow serves finders from the generation last
+    /// published under name and moves to each later one as it appears,
+    /// false when nothing has been published under name
+    //////
+    bool publish(const std::string& name);
+    bool follow(const std::string& name);
+
+    //////
+    /// partitioned load, one read per AM_COLLECT value runs concurrently on its
+    /// own connection from connect, which must be thread safe, the rows
+    /// of all partitions then go into a fresh table that replaces the
+    /// current one, a row no partition returned is gone afterwards
+    //////
+    bool load_partitioned(const std::vector<std::string>& partitions,
+                          std::function<connection_ptr()> connect);
+
+    //////
+    /// write behind, save and save_batch queue rows for the insert proc
+    /// and return at once, the writer thread executes what is queued in
+    /// exec batches of up to batch_size rows, waiting up to linger for a
+    /// batch to fill, a future turns true once its batch was executed,
+    /// the table sees saved rows on the next load
+    //////
+    void start_writer(std::function<connection_ptr()> connect,
+                      std::size_t batch_size,
+                      std::chrono::milliseconds linger);
+    void stop_writer();
+    std::future<bool> save(const shared_position_source::ptr& row);
+    std::future<bool> save_batch(std::vector<shared_position_source::ptr> rows);
+
+    //////
+    /// finder methods
+    //////
+    std::shared_ptr<const shared_position_source> find_by_composite_key(std::string_view source,
+                                                                        int index);
+    std::shared_ptr<const shared_position_source> find_by_source(std::string_view source);
+    std::shared_ptr<const shared_position_source> find_by_index(int index);
+
+  private:
+
+    //////
+    /// default constructor
+    //////
+    shared_position_source_mapping();
+
+    //////
+    /// the mapped shared_position_source table, rows and per index row ids sorted by
+    /// its key laid out in one image, on the heap after load or mapped
+    /// from a file after open_image
+    //////
+    struct shared_position_source_table {
+
+      //////
+      /// index keys
+      //////
+      using composite_key_key = std::tuple<std::string_view, int>;
+      using source_key = std::tuple<std::string_view>;
+      using index_key = std::tuple<int>;
+
+      composite_key_key composite_key_of(std::uint32_t row) const;
+      source_key source_of(std::uint32_t row) const;
+      index_key index_of(std::uint32_t row) const;
+
+      //////
+      /// build sorts every index and lays the rows out as a new image,
+      /// attach reads a table out of an image, nullptr when its sections
+      /// do not fit the rows
+      //////
+      static std::shared_ptr<const shared_position_source_table> build(std::vector<shared_position_source> rows);
+      static std::shared_ptr<const shared_position_source_table> attach(std::shared_ptr<const framework::image> image);
+
+      //////
+      /// image, rows and indices
+      //////
+      std::shared_ptr<const framework::image>         image;
+      framework::image_array<shared_position_source>  rows;
+      framework::image_array<std::uint32_t>           composite_key_ids;
+      framework::image_array<std::uint32_t>           source_ids;
+      framework::image_array<std::uint32_t>           index_ids;
+    };
+
+    //////
+    /// the current table
+    //////
+    std::shared_ptr<const shared_position_source_table> current();
+
+    //////
+    /// the shared_position_source table, replaced whole by load and open_image
+    //////
+    std::shared_ptr<const shared_position_source_table>  shared_position_source_table_;
+
+    //////
+    /// moves the table to the last published generation, lock_ held
+    //////
+    void keep_up();
+
+    //////
+    /// the generations followed and the last one taken
+    //////
+    std::shared_ptr<const framework::shared_follower>  follower_;
+    std::atomic<std::uint64_t>                         followed_;
+
+    //////
+    /// synchronizes access to singleton data
+    //////
+    std::mutex  lock_;
+
+    //////
+    /// hash of the generator release and the fields snapshot files are
+    /// written with
+    //////
+    static constexpr std::uint64_t  snapshot_schema = 0xfaa96e5d343ec8bull;
+
+    //////
+    /// hash of the fields and indices images are laid out for
+    //////
+    static constexpr std::uint64_t  image_schema = 0x26d3eea70dee6033ull;
+
+    //////
+    /// reads one partition into rows, runs on a load_partitioned thread
+    //////
+    static bool fetch_partition(connection_ptr conn,
+                                const std::string& partition,
+                                std::vector<shared_position_source>& rows);
+
+    //////
+    /// renders rows as one exec batch of the insert proc and executes it
+    //////
+    static bool insert_rows(connection_ptr conn,
+                            const shared_position_source::ptr* rows,
+                            std::size_t count);
+
+    //////
+    /// the write behind queue, swapped whole by start and stop
+    //////
+    std::shared_ptr<framework::write_behind<shared_position_source::ptr>>  writer_;
+  };
+
+  //////
+  /// default constructor
+  //////
+  inline
+  shared_position_source_mapping::
+  shared_position_source_mapping() :
+    shared_position_source_table_(shared_position_source_table::build({})),
+    followed_(0) {
+  }
+
+  //////
+  /// singleton accessor
+  //////
+  inline shared_position_source_mapping& 
+  shared_position_source_mapping::
+  instance() {
+    static shared_position_source_mapping instance_;
+    return instance_;
+  }
+
+  //////
+  /// index keys
+  //////
+
+  inline shared_position_source_mapping::shared_position_source_table::composite_key_key
+  shared_position_source_mapping::shared_position_source_table::
+  composite_key_of(std::uint32_t row) const {
+    return composite_key_key(rows[row].source(), rows[row].index());
+  }
+
+  inline shared_position_source_mapping::shared_position_source_table::source_key
+  shared_position_source_mapping::shared_position_source_table::
+  source_of(std::uint32_t row) const {
+    return source_key(rows[row].source());
+  }
+
+  inline shared_position_source_mapping::shared_position_source_table::index_key
+  shared_position_source_mapping::shared_position_source_table::
+  index_of(std::uint32_t row) const {
+    return index_key(rows[row].index());
+  }
+
+  //////
+  /// build
+  //////
+  inline std::shared_ptr<const shared_position_source_mapping::shared_position_source_table>
+  shared_position_source_mapping::shared_position_source_table::
+  build(std::vector<shared_position_source> rows) {
+
+    static_assert(std::is_trivially_copyable<shared_position_source>::value,
+                  "mapped rows are copied byte for byte");
+
+    std::vector<std::uint32_t> composite_key_ids(rows.size());
+    std::iota(composite_key_ids.begin(), composite_key_ids.end(), 0);
+    std::stable_sort(composite_key_ids.begin(), composite_key_ids.end(),
+                     [&rows](std::uint32_t a, std::uint32_t b) {
+                       return composite_key_key(rows[a].source(), rows[a].index()) <
+                              composite_key_key(rows[b].source(), rows[b].index());
+                     });
+
+    std::vector<std::uint32_t> source_ids(rows.size());
+    std::iota(source_ids.begin(), source_ids.end(), 0);
+    std::stable_sort(source_ids.begin(), source_ids.end(),
+                     [&rows](std::uint32_t a, std::uint32_t b) {
+                       return source_key(rows[a].source()) <
+                              source_key(rows[b].source());
+                     });
+
+    std::vector<std::uint32_t> index_ids(rows.size());
+    std::iota(index_ids.begin(), index_ids.end(), 0);
+    std::stable_sort(index_ids.begin(), index_ids.end(),
+                     [&rows](std::uint32_t a, std::uint32_t b) {
+                       return index_key(rows[a].index()) <
+                              index_key(rows[b].index());
+                     });
+
+    return attach(framework::image::build(image_schema, sizeof(shared_position_source), rows.size(), {
+      {rows.data(), rows.size() * sizeof(shared_position_source)},
+      {composite_key_ids.data(), composite_key_ids.size() * sizeof(std::uint32_t)},
+      {source_ids.data(), source_ids.size() * sizeof(std::uint32_t)},
+      {index_ids.data(), index_ids.size() * sizeof(std::uint32_t)}
+    }));
+  }
+
+  //////
+  /// attach, the row ids are trusted as written so opening costs
+  /// nothing per row
+  //////
+  inline std::shared_ptr<const shared_position_source_mapping::shared_position_source_table>
+  shared_position_source_mapping::shared_position_source_table::
+  attach(std::shared_ptr<const framework::image> image) {
+
+    if (! image) {
+      return nullptr;
+    }
+    auto table = std::make_shared<shared_position_source_table>();
+    table->image = image;
+    table->rows = image->get<shared_position_source>(0);
+    std::size_t n = table->rows.size();
+    if (n != image->rows()) {
+      return nullptr;
+    }
+    table->composite_key_ids = image->get<std::uint32_t>(1);
+    if (table->composite_key_ids.size() != n) {
+      return nullptr;
+    }
+    table->source_ids = image->get<std::uint32_t>(2);
+    if (table->source_ids.size() != n) {
+      return nullptr;
+    }
+    table->index_ids = image->get<std::uint32_t>(3);
+    if (table->index_ids.size() != n) {
+      return nullptr;
+    }
+    return table;
+  }
+
+  //////
+  /// current
+  //////
+  inline std::shared_ptr<const shared_position_source_mapping::shared_position_source_table>
+  shared_position_source_mapping::
+  current() {
+    std::lock_guard<std::mutex>  guard(lock_);
+    if (follower_ && follower_->generation() != followed_.load()) {
+      keep_up();
+    }
+    return shared_position_source_table_;
+  }
+
+  //////
+  /// load
+  //////
+  inline bool
+  shared_position_source_mapping::
+  load(connection_ptr conn) {
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    std::string sp = "exec vm_read_rate_source";
+    shared_position_source area;
+    int result = conn->execute(sp);
+    if (result == FAIL) return false;
+
+    std::vector<shared_position_source> rows;
+    area.bind(conn);
+    while (conn->nextRow() != NO_MORE_ROWS) {
+      area.fetched();
+      rows.push_back(area);
+    }
+    auto next = shared_position_source_table::build(std::move(rows));
+    shared_position_source_table_ = next;
+    return true;
+  }
+
+  //////
+  /// partitioned load
+  //////
+
+  inline bool
+  shared_position_source_mapping::
+  fetch_partition(connection_ptr conn,
+                  const std::string& partition,
+                  std::vector<shared_position_source>& rows) {
+
+    if (! conn) return false;
+    std::string sp = "exec vm_read_rate_source " + framework::sql_literal(partition);
+    shared_position_source area;
+    int result = conn->execute(sp);
+    if (result == FAIL) return false;
+
+    area.bind(conn);
+    while (conn->nextRow() != NO_MORE_ROWS) {
+      area.fetched();
+      rows.push_back(area);
+    }
+    return true;
+  }
+
+  inline bool
+  shared_position_source_mapping::
+  load_partitioned(const std::vector<std::string>& partitions,
+                   std::function<connection_ptr()> connect) {
+
+    std::vector<std::vector<shared_position_source>> fetched(partitions.size());
+    std::vector<std::future<bool>> fetches;
+    for (std::size_t i = 0; i < partitions.size(); ++i) {
+      fetches.push_back(std::async(std::launch::async, [&, i] {
+        return fetch_partition(connect(), partitions[i], fetched[i]);
+      }));
+    }
+    bool complete = true;
+    for (auto& f : fetches) {
+      complete = f.get() && complete;
+    }
+    if (! complete) return false;
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    std::vector<shared_position_source> rows;
+    for (auto& part : fetched) {
+      for (auto& area : part) {
+        rows.push_back(area);
+      }
+    }
+    auto next = shared_position_source_table::build(std::move(rows));
+    shared_position_source_table_ = next;
+    return true;
+  }
+
+  //////
+  /// snapshot save
+  //////
+  inline bool
+  shared_position_source_mapping::
+  save_snapshot(const std::string& path) {
+
+    framework::snapshot_writer out(path, snapshot_schema);
+    std::uint64_t count = 0;
+    auto table = current();
+    for (const auto& row : table->rows) {
+      out.write_string(row.source());
+      out.write_string(row.type());
+      out.write_string(row.date());
+      out.write(row.index());
+      ++count;
+    }
+    return out.commit(count);
+  }
+
+  //////
+  /// snapshot load
+  //////
+  inline bool
+  shared_position_source_mapping::
+  load_snapshot(const std::string& path) {
+
+    framework::snapshot_reader in(path, snapshot_schema);
+    if (! in) return false;
+
+    std::lock_guard<std::mutex>  guard(lock_);
+    shared_position_source area;
+    std::vector<shared_position_source> rows;
+    for (std::uint64_t i = 0; i < in.rows() && ! in.overrun(); ++i) {
+      area.source(in.read_string());
+      area.type(in.read_string());
+      area.date(in.read_string());
+      area.index(in.read<int>());
+      rows.push_back(area);
+    }
+    if (! in.complete()) {
+      return false;
+    }
+    auto next = shared_position_source_table::build(std::move(rows));
+    shared_position_source_table_ = next;
+    return true;
+  }
+
+  //////
+  /// save_image
+  //////
+  inline bool
+  shared_position_source_mapping::
+  save_image(const std::string& path) {
+    return current()->image->save(path);
+  }
+
+  //////
+  /// open_image
+  //////
+  inline bool
+  shared_position_source_mapping::
+  open_image(const std::string& path) {
+
+    auto next = shared_position_source_table::attach(framework::image::map(
+      path, image_schema, sizeof(shared_position_source), 4));
+    if (! next) {
+      return false;
+    }
+    std::lock_guard<std::mutex>  guard(lock_);
+    shared_position_source_table_ = next;
+    return true;
+  }
+
+  //////
+  /// publish
+  //////
+  inline bool
+  shared_position_source_mapping::
+  publish(const std::string& name) {
+    return framework::publish_image(name, *current()->image);
+  }
+
+  //////
+  /// follow
+  //////
+  inline bool
+  shared_position_source_mapping::
+  follow(const std::string& name) {
+
+    auto follower = std::make_shared<const framework::shared_follower>(name);
+    if (! *follower) {
+      return false;
+    }
+    std::lock_guard<std::mutex>  guard(lock_);
+    follower_ = follower;
+    followed_.store(0);
+    keep_up();
+    return true;
+  }
+
+  //////
+  /// keep_up, a generation that will not open is skipped and the
+  /// table stays on the last one that did
+  //////
+  inline void
+  shared_position_source_mapping::
+  keep_up() {
+
+    for (;;) {
+      std::uint64_t generation = follower_->generation();
+      if (generation == followed_.load()) {
+        return;
+      }
+      auto next = shared_position_source_table::attach(follower_->open(
+        generation, image_schema, sizeof(shared_position_source), 4));
+      if (next) {
+        shared_position_source_table_ = next;
+      }
+      // removed while it was opened, a later one is published
+      else if (follower_->generation() != generation) {
+        continue;
+      }
+      followed_.store(generation);
+    }
+  }
+
+  //////
+  /// write behind
+  //////
+
+  inline void
+  shared_position_source_mapping::
+  start_writer(std::function<connection_ptr()> connect,
+               std::size_t batch_size,
+               std::chrono::milliseconds linger) {
+
+    auto flush = [connect](const shared_position_source::ptr* rows, std::size_t count) {
+      connection_ptr conn = connect();
+      return conn && insert_rows(conn, rows, count);
+    };
+    auto next = std::make_shared<framework::write_behind<shared_position_source::ptr>>(batch_size, linger, flush);
+    // the prior writer flushes its queue as it goes out of scope
+    auto prior = std::atomic_exchange(&writer_, next);
+  }
+
+  inline void
+  shared_position_source_mapping::
+  stop_writer() {
+    // flushes the queue unless a save still holds the writer
+    auto prior = std::atomic_exchange(&writer_, std::shared_ptr<framework::write_behind<shared_position_source::ptr>>());
+  }
+
+  inline std::future<bool>
+  shared_position_source_mapping::
+  save(const shared_position_source::ptr& row) {
+
+    auto writer = std::atomic_load(&writer_);
+    if (! writer) {
+      std::promise<bool> rejected;
+      rejected.set_value(false);
+      return rejected.get_future();
+    }
+    return writer->push(row);
+  }
+
+  inline std::future<bool>
+  shared_position_source_mapping::
+  save_batch(std::vector<shared_position_source::ptr> rows) {
+
+    auto writer = std::atomic_load(&writer_);
+    if (! writer) {
+      std::promise<bool> rejected;
+      rejected.set_value(false);
+      return rejected.get_future();
+    }
+    return writer->push(std::move(rows));
+  }
+
+  inline bool
+  shared_position_source_mapping::
+  insert_rows(connection_ptr conn,
+              const shared_position_source::ptr* rows,
+              std::size_t count) {
+
+    std::string sp;
+    for (std::size_t i = 0; i < count; ++i) {
+      const shared_position_source& row = *rows[i];
+      sp += "exec vm_insert_rate_source ";
+      sp += framework::sql_literal(row.source());
+      sp += ", ";
+      sp += framework::sql_literal(row.type());
+      sp += ", ";
+      sp += framework::sql_literal(row.date());
+      sp += ", ";
+      sp += framework::sql_literal(row.index());
+      sp += "\n";
+    }
+    return conn->execute(sp) != FAIL;
+  }
+
+  //////
+  /// finders
+  //////
+
+  inline std::shared_ptr<const shared_position_source> 
+  shared_position_source_mapping::
+  find_by_composite_key(std::string_view source,
+                        int index) {
+
+    auto table = current();
+    const auto& ids = table->composite_key_ids;
+    shared_position_source_table::composite_key_key key(source, index);
+    auto below = [&table, &key](std::uint32_t row) {
+      return table->composite_key_of(row) < key;
+    };
+    std::size_t q = framework::branchless_lower_bound(ids, below);
+    if (q == ids.size() || table->composite_key_of(ids[q]) != key) {
+      return std::shared_ptr<const shared_position_source>();
+    }
+    return std::shared_ptr<const shared_position_source>(table, &table->rows[ids[q]]);
+  }
+
+  inline std::shared_ptr<const shared_position_source> 
+  shared_position_source_mapping::
+  find_by_source(std::string_view source) {
+
+    auto table = current();
+    const auto& ids = table->source_ids;
+    shared_position_source_table::source_key key(source);
+    auto below = [&table, &key](std::uint32_t row) {
+      return table->source_of(row) < key;
+    };
+    std::size_t q = framework::branchless_lower_bound(ids, below);
+    if (q == ids.size() || table->source_of(ids[q]) != key) {
+      return std::shared_ptr<const shared_position_source>();
+    }
+    return std::shared_ptr<const shared_position_source>(table, &table->rows[ids[q]]);
+  }
+
+  inline std::shared_ptr<const shared_position_source> 
+  shared_position_source_mapping::
+  find_by_index(int index) {
+
+    auto table = current();
+    const auto& ids = table->index_ids;
+    shared_position_source_table::index_key key(index);
+    auto below = [&table, &key](std::uint32_t row) {
+      return table->index_of(row) < key;
+    };
+    std::size_t q = framework::branchless_lower_bound(ids, below);
+    if (q == ids.size() || table->index_of(ids[q]) != key) {
+      return std::shared_ptr<const shared_position_source>();
+    }
+    return std::shared_ptr<const shared_position_source>(table, &table->rows[ids[q]]);
+  }
+
+}}
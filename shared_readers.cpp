@@ -0,0 +1,118 @@
+//////
+/// one loader process serving many reader processes through shared
+/// memory, shared_position_source.hpp is generated from shared_readers.json
+/// and built against the synthetic connection of framework/bench
+///
+///   g++ -std=c++17 -O2 -Iframework/bench -I. -o shared_readers
+///     shared_readers.cpp -lpthread -lrt
+///   ./shared_readers [readers]
+///
+/// the readers start first and never load, they follow what the loader
+/// publishes, find every row of the first generation and then wait for a
+/// row only the second one has
+//////
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <framework/synthetic.hpp>
+#include "shared_position_source.hpp"
+
+namespace {
+
+  using rates::generated::shared_position_source_mapping;
+
+  constexpr std::size_t rows  = 10000;
+  constexpr std::size_t width = 64;
+
+  const std::string name = "shared_readers." + std::to_string(::getpid());
+
+  //////
+  /// reader process, the exit status tells the loader how it went
+  //////
+  int
+  reader(std::chrono::seconds patience) {
+
+    auto& m = shared_position_source_mapping::instance();
+    auto deadline = std::chrono::steady_clock::now() + patience;
+    while (! m.follow(name)) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return 2;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (std::size_t i = 0; i < rows; ++i) {
+      std::string key = rates::framework::synthetic_text("position_source", i, width);
+      auto row = m.find_by_composite_key(key, int(i));
+      if (! row || row->index() != int(i)) {
+        return 3;
+      }
+    }
+    while (! m.find_by_index(int(rows))) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return 4;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+  }
+
+  //////
+  /// a generation of count synthetic rows
+  //////
+  rates::connection_ptr
+  synthetic_connection(std::size_t count) {
+    auto conn = std::make_shared<rates::connection>(count);
+    conn->column("position_source", width, count);
+    conn->column("position_type", width, 16);
+    return conn;
+  }
+
+}
+
+int
+main(int argc, char** argv) {
+
+  int readers = argc > 1 ? std::atoi(argv[1]) : 8;
+  std::vector<pid_t> children;
+  for (int i = 0; i < readers; ++i) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      std::_Exit(reader(std::chrono::seconds(30)));
+    }
+    if (pid < 0) {
+      std::cerr << "fork failed" << std::endl;
+      return 1;
+    }
+    children.push_back(pid);
+  }
+
+  auto& m = shared_position_source_mapping::instance();
+  bool published = m.load(synthetic_connection(rows)) && m.publish(name);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  published = published && m.load(synthetic_connection(rows + 1)) && m.publish(name);
+
+  int served = 0;
+  for (pid_t pid : children) {
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      ++served;
+    }
+    else {
+      std::cerr << "reader " << pid << " failed with " << WEXITSTATUS(status) << std::endl;
+    }
+  }
+  rates::framework::remove_shared(name);
+  std::cout << (published ? "one loader" : "a failed loader") << " served " << served
+            << " of " << readers << " readers" << std::endl;
+  return published && served == readers ? 0 : 1;
+}